@@ -2,13 +2,99 @@
 
 
 #include "Inventory.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "InventoryCatalogSubsystem.h"
+#include "InventoryWorldSubsystem.h"
+#include "InventorySystem.h"
+#include "InventorySort.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	void AddToStatTotal(TArray<int32>& StatTotals, const int32 StatId, const int32 Delta)
+	{
+		if (StatTotals.Num() <= StatId)
+			StatTotals.AddZeroed(StatId + 1 - StatTotals.Num());
+
+		StatTotals[StatId] += Delta;
+	}
+
+	// Saved states start with "ISAV", the format version and the catalog 
+	// fingerprint, followed by the number of saved items and an entry per
+	// item in item id order. Each entry is the distance to the previous 
+	// saved item id minus one and the quantity shifted left by one with the
+	// equipped bit below it, both as varints.
+	constexpr uint32 SaveStateMagic = 0x56415349;
+	constexpr uint64 SaveStateVersion = 1;
+
+	void WriteFixed(TArray<uint8>& OutData, const uint64 Value, const int32 NumBytes)
+	{
+		for (int32 Byte = 0; Byte < NumBytes; ++Byte)
+		{
+			OutData.Add(uint8(Value >> (8 * Byte)));
+		}
+	}
+
+	void WriteVarint(TArray<uint8>& OutData, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			OutData.Add(uint8(Value) | 0x80);
+			Value >>= 7;
+		}
+		OutData.Add(uint8(Value));
+	}
+
+	struct FSaveStateReader
+	{
+		TConstArrayView<uint8> Data;
+		int32 Offset = 0;
+
+		bool ReadFixed(uint64& OutValue, const int32 NumBytes)
+		{
+			if (Data.Num() - Offset < NumBytes)
+				return false;
+
+			OutValue = 0;
+			for (int32 Byte = 0; Byte < NumBytes; ++Byte)
+			{
+				OutValue |= uint64(Data[Offset++]) << (8 * Byte);
+			}
+			return true;
+		}
+
+		bool ReadVarint(uint64& OutValue)
+		{
+			OutValue = 0;
+			for (int32 Shift = 0; Shift < 64 && Offset < Data.Num(); Shift += 7)
+			{
+				const uint8 Byte = Data[Offset++];
+				OutValue |= uint64(Byte & 0x7f) << Shift;
+
+				if ((Byte & 0x80) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		bool IsAtEnd() const { return Offset == Data.Num(); }
+	};
+
+	// Copies a view into a string, reusing its allocation
+	void AssignString(FString& OutString, FStringView View)
+	{
+		OutString.Reset(View.Len());
+		OutString.AppendChars(View.GetData(), View.Len());
+	}
+}
 
 // Sets default values for this component's properties
 UInventory::UInventory()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// Time dependent work of all inventories is batched by UInventoryWorldSubsystem,
+	// so inventories never need to tick on their own.
+	PrimaryComponentTick.bCanEverTick = false;
 
 	// ...
 }
@@ -17,14 +103,26 @@ UInventory::UInventory()
 TArray<FInventoryItem> UInventory::GetEquippedItems()
 {
 	TArray<FInventoryItem> EquippedItemsArray;
+	GetEquippedItemsInto(EquippedItemsArray);
+	return EquippedItemsArray;
+}
 
-	for (auto& Elem : Inventory)
+void UInventory::GetEquippedItemsInto(TArray<FInventoryItem>& OutItems) const
+{
+	OutItems.SetNum(EquippedItemIds.Num());
+
+	for (int32 Index = 0; Index < EquippedItemIds.Num(); ++Index)
 	{
-		if (Elem.Value.IsEquipped)
-			EquippedItemsArray.Add(Elem.Value);
+		FillInventoryItem(EquippedItemIds[Index].Index, OutItems[Index]);
 	}
+}
 
-	return EquippedItemsArray;
+void UInventory::ForEachEquippedItem(TFunctionRef<void(const FInventoryItemView& Item)> Visitor) const
+{
+	for (const FInventoryItemId ItemId : EquippedItemIds)
+	{
+		Visitor(MakeItemView(ItemId.Index));
+	}
 }
 
 // Called when the game starts
@@ -32,25 +130,58 @@ void UInventory::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	WorldSubsystem = GetWorld()->GetSubsystem<UInventoryWorldSubsystem>();
+	if (WorldSubsystem)
+		WorldSubsystem->RegisterInventory(this);
 }
 
+// Called when the game ends or the component is destroyed
+void UInventory::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (WorldSubsystem)
+		WorldSubsystem->UnregisterInventory(this);
+
+	WorldSubsystem = nullptr;
+
+	Super::EndPlay(EndPlayReason);
+}
 
-// Called every frame
-void UInventory::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+UInventoryCatalog* UInventory::GetCatalog()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (!Catalog)
+	{
+		const UWorld* World = GetWorld();
+		const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		const UInventoryCatalogSubsystem* CatalogSubsystem = GameInstance ? GameInstance->GetSubsystem<UInventoryCatalogSubsystem>() : nullptr;
 
-	// ...
+		// Inventories outside of a game instance (e.g. editor previews) get a
+		// catalog of their own.
+		Catalog = CatalogSubsystem ? CatalogSubsystem->GetCatalog() : NewObject<UInventoryCatalog>(this);
+	}
+
+	return Catalog;
+}
+
+bool UInventory::SetCatalog(UInventoryCatalog* InCatalog)
+{
+	if (!InCatalog || RegisteredItems.Num() > 0)
+		return false;
+
+	Catalog = InCatalog;
+	return true;
 }
 
 InventoryError UInventory::AddPossibleStat(const FString PossibleStat)
 {
-	if (PossibleStats.Contains(PossibleStat))
+	const int32 StatId = GetCatalog()->AddStat(PossibleStat);
+
+	if (PossibleStats.Num() <= StatId)
+		PossibleStats.Add(false, StatId + 1 - PossibleStats.Num());
+
+	if (PossibleStats[StatId])
 		return InventoryError::EDuplicateStat;
 
-	PossibleStats.Add(PossibleStat);
+	PossibleStats[StatId] = true;
 
 	return InventoryError::ESuccess;
 }
@@ -59,115 +190,1135 @@ TArray<FString> UInventory::GetPossibleStats()
 {
 	TArray<FString> PossibleStatsArray;
 
-	for (auto& Elem : PossibleStats)
+	ForEachPossibleStat([&PossibleStatsArray](int32 StatId, FStringView StatName)
 	{
-		PossibleStatsArray.Add(*Elem);
-	}
+		PossibleStatsArray.Emplace(StatName);
+	});
 
 	return PossibleStatsArray;
 }
 
+void UInventory::ForEachPossibleStat(TFunctionRef<void(int32 StatId, FStringView StatName)> Visitor) const
+{
+	for (TConstSetBitIterator<> It(PossibleStats); It; ++It)
+	{
+		Visitor(It.GetIndex(), Catalog->GetStatName(It.GetIndex()));
+	}
+}
+
 InventoryError UInventory::AddInventoryItemType(const FString& Name, 
 												const FString& FlavorText, 
 												const UTexture2D* Thumbnail, 
 												const UTexture2D* FullImage, 
-												const TMap<FString, FBoostAndDuration> StatsBoostsAndDurations, 
+												const TMap<FString, FBoostAndDuration>& StatsBoostsAndDurations, 
 												const int MaximumQuantity /* = 1 */,
 												const bool IsConsumable /* = true*/, 
 												const bool IsEquippable /* = false*/)
 {
-	for (auto& Elem : StatsBoostsAndDurations)
+	FInventoryItemId ItemId;
+	return AddInventoryItemType(ItemId, Name, FlavorText, Thumbnail, FullImage, StatsBoostsAndDurations, 
+								MaximumQuantity, IsConsumable, IsEquippable);
+}
+
+InventoryError UInventory::AddInventoryItemType(FInventoryItemId& OutItemId,
+												const FString& Name, 
+												const FString& FlavorText, 
+												const UTexture2D* Thumbnail, 
+												const UTexture2D* FullImage, 
+												const TMap<FString, FBoostAndDuration>& StatsBoostsAndDurations, 
+												const int MaximumQuantity /* = 1 */,
+												const bool IsConsumable /* = true*/, 
+												const bool IsEquippable /* = false*/)
+{
+	// Reject duplicates before doing any work
+	OutItemId = GetCatalog()->FindItemId(Name);
+	if (IsRegistered(OutItemId))
+		return InventoryError::EDuplicateItemType;
+
+	OutItemId = FInventoryItemId();
+
+	FInventoryItemDefinition Definition;
+	Definition.Name = Name;
+	Definition.FlavorText = FlavorText;
+	Definition.Thumbnail = const_cast<UTexture2D*>(Thumbnail);
+	Definition.FullImage = const_cast<UTexture2D*>(FullImage);
+	Definition.StatsBoostsAndDurations = StatsBoostsAndDurations;
+	Definition.MaximumQuantity = MaximumQuantity;
+	Definition.IsConsumable = IsConsumable;
+	Definition.IsEquippable = IsEquippable;
+
+	FInventoryItemId ItemId;
+	const InventoryError Result = GetCatalog()->AddItemType(MoveTemp(Definition), ItemId, &PossibleStats);
+	OutItemId = ItemId;
+
+	if (Result != InventoryError::ESuccess)
+		return Result;
+
+	return RegisterItemType(ItemId);
+}
+
+InventoryError UInventory::AddInventoryItemTypes(TArray<FInventoryItemDefinition>&& Definitions, TArray<FInventoryItemId>& OutItemIds, 
+												TArray<InventoryError>& OutResults)
+{
+	UInventoryCatalog* const TargetCatalog = GetCatalog();
+
+	// Item types this inventory already has are duplicates before anything
+	// else, as in AddInventoryItemType, whatever the catalog says about them
+	TArray<FInventoryItemId> RegisteredItemIds;
+	RegisteredItemIds.Reserve(Definitions.Num());
+	for (const FInventoryItemDefinition& Definition : Definitions)
 	{
-		if (!PossibleStats.Contains(Elem.Key))
-			return InventoryError::EInvalidStatUsed;
+		const FInventoryItemId ItemId = TargetCatalog->FindItemId(Definition.Name);
+		RegisteredItemIds.Add(IsRegistered(ItemId) ? ItemId : FInventoryItemId());
 	}
 
-	FInventoryItem inventoryItemToAdd;
-	inventoryItemToAdd.Name = Name;
-	inventoryItemToAdd.FlavorText = FlavorText;
-	inventoryItemToAdd.Thumbnail = const_cast<UTexture2D*>(Thumbnail);
-	inventoryItemToAdd.FullImage = const_cast<UTexture2D*>(FullImage);
-	inventoryItemToAdd.StatsBoostsAndDurations = StatsBoostsAndDurations;
-	inventoryItemToAdd.MaximumQuantity = MaximumQuantity;
-	inventoryItemToAdd.IsConsumable = IsConsumable;
-	inventoryItemToAdd.IsEquippable = IsEquippable;
-	
-	if (Inventory.Contains(Name))
+	TargetCatalog->AddItemTypes(Definitions, OutItemIds, OutResults, &PossibleStats);
+
+	InventoryError FirstError = InventoryError::ESuccess;
+	for (int32 Index = 0; Index < OutResults.Num(); ++Index)
+	{
+		InventoryError& Result = OutResults[Index];
+		if (RegisteredItemIds[Index].IsValid())
+		{
+			OutItemIds[Index] = RegisteredItemIds[Index];
+			Result = InventoryError::EDuplicateItemType;
+		}
+		else if (Result == InventoryError::ESuccess)
+		{
+			Result = RegisterItemType(OutItemIds[Index]);
+		}
+
+		if (Result != InventoryError::ESuccess && FirstError == InventoryError::ESuccess)
+			FirstError = Result;
+	}
+
+	Definitions.Reset();
+	return FirstError;
+}
+
+InventoryError UInventory::AddInventoryItemTypesFromDataTable(const UDataTable* ItemTable)
+{
+	if (!ItemTable || !ItemTable->GetRowStruct() || !ItemTable->GetRowStruct()->IsChildOf(FInventoryItemDefinition::StaticStruct()))
+		return InventoryError::EInvalidItemType;
+
+	const TMap<FName, uint8*>& RowMap = ItemTable->GetRowMap();
+
+	TArray<FInventoryItemDefinition> Definitions;
+	Definitions.Reserve(RowMap.Num());
+
+	for (const TPair<FName, uint8*>& Row : RowMap)
+	{
+		FInventoryItemDefinition& Definition = Definitions.Add_GetRef(*reinterpret_cast<const FInventoryItemDefinition*>(Row.Value));
+
+		if (Definition.Name.IsEmpty())
+			Definition.Name = Row.Key.ToString();
+	}
+
+	TArray<FInventoryItemId> ItemIds;
+	TArray<InventoryError> Results;
+	return AddInventoryItemTypes(MoveTemp(Definitions), ItemIds, Results);
+}
+
+void UInventory::ReserveItemStates(const int32 NumItems)
+{
+	if (RegisteredItems.Num() >= NumItems)
+		return;
+
+	const int32 NumToAdd = NumItems - RegisteredItems.Num();
+	Quantities.AddZeroed(NumToAdd);
+	ItemGenerations.AddZeroed(NumToAdd);
+	PendingChangeIndices.AddZeroed(NumToAdd);
+	RegisteredItems.Add(false, NumToAdd);
+	EquippedItems.Add(false, NumToAdd);
+	OwnedConsumableItems.Add(false, NumToAdd);
+	OwnedEquippableItems.Add(false, NumToAdd);
+}
+
+InventoryError UInventory::RegisterItemType(const FInventoryItemId ItemId)
+{
+	if (IsRegistered(ItemId))
 		return InventoryError::EDuplicateItemType;
 
-	Inventory.Add(Name, inventoryItemToAdd);
+	ReserveItemStates(ItemId.Index + 1);
+	RegisteredItems[ItemId.Index] = true;
+	PublishedGeneration = INDEX_NONE;
+
+	if (bPublishSnapshots)
+		MarkDirty();
 
 	return InventoryError::ESuccess;
 }
 
+FInventoryItemId UInventory::FindItemId(FStringView Name) const
+{
+	if (!Catalog)
+		return FInventoryItemId();
+
+	const FInventoryItemId ItemId = Catalog->FindItemId(Name);
+	return IsRegistered(ItemId) ? ItemId : FInventoryItemId();
+}
+
+bool UInventory::GetItem(const FInventoryItemId ItemId, FInventoryItem& OutItem) const
+{
+	if (!IsRegistered(ItemId))
+		return false;
+
+	FillInventoryItem(ItemId.Index, OutItem);
+	return true;
+}
+
+int32 UInventory::GetItemQuantity(const FInventoryItemId ItemId) const
+{
+	return IsRegistered(ItemId) ? Quantities[ItemId.Index] : 0;
+}
+
+bool UInventory::IsItemEquipped(const FInventoryItemId ItemId) const
+{
+	return IsRegistered(ItemId) && EquippedItems[ItemId.Index];
+}
+
 InventoryError UInventory::AddItem(const FString& ItemToAdd, const int Quantity /* = 1 */)
+{
+	return AddItem(FindItemId(ItemToAdd), Quantity);
+}
+
+InventoryError UInventory::AddItem(const FInventoryItemId ItemToAdd, const int Quantity /* = 1 */)
 {	
-	if (!Inventory.Contains(ItemToAdd))
+	if (!IsRegistered(ItemToAdd))
 		return InventoryError::EInvalidItemType;
 
-	if (Inventory[ItemToAdd].Quantity + Quantity > Inventory[ItemToAdd].MaximumQuantity)
+	const int32 CurrentQuantity = Quantities[ItemToAdd.Index];
+
+	if (CurrentQuantity + Quantity > Catalog->GetMaximumQuantity(ItemToAdd))
 		return InventoryError::EMaxQuantityExceeded;
 
-	Inventory[ItemToAdd].Quantity += Quantity;
+	SetQuantity(ItemToAdd.Index, CurrentQuantity + Quantity);
 
 	return InventoryError::ESuccess;
 }
 
 InventoryError UInventory::ConsumeItem(const FString& ItemToConsume, const int Quantity /* = 1 */)
 {
-	if (!Inventory.Contains(ItemToConsume))
+	return ConsumeItem(FindItemId(ItemToConsume), Quantity);
+}
+
+InventoryError UInventory::ConsumeItem(const FInventoryItemId ItemToConsume, const int Quantity /* = 1 */)
+{
+	if (!IsRegistered(ItemToConsume))
 		return InventoryError::EInvalidItemType;
 
-	if (Inventory[ItemToConsume].Quantity == 0)
+	if (!Catalog->IsConsumable(ItemToConsume))
+		return InventoryError::ENotConsumable;
+
+	const int32 CurrentQuantity = Quantities[ItemToConsume.Index];
+
+	if (CurrentQuantity == 0)
 		return InventoryError::ENoItemsToConsume;
 
-	if (Inventory[ItemToConsume].Quantity - Quantity <= 0)
-		Inventory[ItemToConsume].Quantity = 0;
+	const int32 ConsumedQuantity = FMath::Min(CurrentQuantity, Quantity);
+
+	if (CurrentQuantity - Quantity <= 0)
+		SetQuantity(ItemToConsume.Index, 0);
 	else
-		Inventory[ItemToConsume].Quantity -= Quantity;
+		SetQuantity(ItemToConsume.Index, CurrentQuantity - Quantity);
+
+	if (ConsumedQuantity > 0)
+		StartConsumedBoosts(ItemToConsume.Index, ConsumedQuantity);
 
 	return InventoryError::ESuccess;
 }
 
 InventoryError UInventory::EquipItem(const FString& ItemToEquip)
 {
-	if (!Inventory.Contains(ItemToEquip))
+	return EquipItem(FindItemId(ItemToEquip));
+}
+
+InventoryError UInventory::EquipItem(const FInventoryItemId ItemToEquip)
+{
+	if (!IsRegistered(ItemToEquip))
 		return InventoryError::EInvalidItemType;
 	
-	if (!Inventory[ItemToEquip].IsEquippable)
+	if (!Catalog->IsEquippable(ItemToEquip))
 		return InventoryError::ENotEquippable;
 
-	if (Inventory[ItemToEquip].IsEquipped)
+	if (EquippedItems[ItemToEquip.Index])
 		return InventoryError::EAlreadyEquipped;
 
-	Inventory[ItemToEquip].IsEquipped = true;
+	SetEquipped(ItemToEquip.Index, true);
 
 	return InventoryError::ESuccess;
 }
 
 InventoryError UInventory::UnequipItem(const FString& ItemToUnequip)
 {
-	if (!Inventory.Contains(ItemToUnequip))
+	return UnequipItem(FindItemId(ItemToUnequip));
+}
+
+InventoryError UInventory::UnequipItem(const FInventoryItemId ItemToUnequip)
+{
+	if (!IsRegistered(ItemToUnequip))
 		return InventoryError::EInvalidItemType;
 
-	if (!Inventory[ItemToUnequip].IsEquippable)
+	if (!Catalog->IsEquippable(ItemToUnequip))
 		return InventoryError::ENotEquippable;
 
-	if (!Inventory[ItemToUnequip].IsEquipped)
+	if (!EquippedItems[ItemToUnequip.Index])
 		return InventoryError::ENotEquipped;
 
-	Inventory[ItemToUnequip].IsEquipped = false;
+	SetEquipped(ItemToUnequip.Index, false);
 	return InventoryError::ESuccess;
 }
 
+void UInventory::SetQuantity(const int32 Index, const int32 NewQuantity)
+{
+	if (Quantities[Index] == NewQuantity)
+		return;
+
+	RecordChange(Index);
+
+	if ((Quantities[Index] > 0) != (NewQuantity > 0))
+	{
+		UpdateOwnedIndexes(Index, NewQuantity > 0);
+		UpdateOwnedByName(Index, NewQuantity > 0);
+	}
+
+	UpdateOwnedByQuantity(Index, Quantities[Index], NewQuantity);
+
+	Quantities[Index] = NewQuantity;
+	MarkItemChanged(Index);
+}
+
+void UInventory::SetEquipped(const int32 Index, const bool bNewEquipped)
+{
+	if (EquippedItems[Index] == bNewEquipped)
+		return;
+
+	RecordChange(Index);
+
+	EquippedItems[Index] = bNewEquipped;
+
+	if (bNewEquipped)
+		EquippedItemIds.Add(FInventoryItemId(Index));
+	else
+		EquippedItemIds.RemoveSingleSwap(FInventoryItemId(Index), false);
+
+	ApplyEquippedModifiers(Index, bNewEquipped ? 1 : -1);
+
+	MarkItemChanged(Index);
+}
+
+void UInventory::UpdateOwnedIndexes(const int32 Index, const bool bOwned)
+{
+	const FInventoryItemId ItemId(Index);
+	const bool bConsumable = Catalog->IsConsumable(ItemId);
+	const bool bEquippable = Catalog->IsEquippable(ItemId);
+
+	OwnedConsumableItems[Index] = bOwned && bConsumable;
+	OwnedEquippableItems[Index] = bOwned && bEquippable;
+
+	const TConstArrayView<FInventoryStatModifier> Modifiers = Catalog->GetModifiers(ItemId);
+	if (Modifiers.Num() == 0)
+		return;
+
+	// Modifiers are sorted by stat id so the last one has the highest
+	const int32 MaxStatId = Modifiers.Last().StatId;
+	if (OwnedItemsByStat.Num() <= MaxStatId)
+		OwnedItemsByStat.SetNum(MaxStatId + 1);
+
+	auto UpdateEntries = [bOwned](TArray<FInventoryStatIndexEntry>& Entries, const FInventoryStatIndexEntry& Entry)
+	{
+		const int32 Position = Algo::LowerBound(Entries, Entry, &FInventoryStatIndexEntry::Precedes);
+
+		if (bOwned)
+		{
+			Entries.Insert(Entry, Position);
+		}
+		else
+		{
+			check(Entries.IsValidIndex(Position) && Entries[Position] == Entry);
+			Entries.RemoveAt(Position, 1, false);
+		}
+	};
+
+	for (const FInventoryStatModifier& Modifier : Modifiers)
+	{
+		const FInventoryStatIndexEntry Entry = { Modifier.Boost, ItemId };
+		FOwnedStatIndex& StatIndex = OwnedItemsByStat[Modifier.StatId];
+
+		UpdateEntries(StatIndex.Entries[(int32)InventoryItemFilter::EAll], Entry);
+
+		if (bConsumable)
+			UpdateEntries(StatIndex.Entries[(int32)InventoryItemFilter::EConsumable], Entry);
+
+		if (bEquippable)
+			UpdateEntries(StatIndex.Entries[(int32)InventoryItemFilter::EEquippable], Entry);
+	}
+}
+
+void UInventory::UpdateOwnedByQuantity(const int32 Index, const int32 OldQuantity, const int32 NewQuantity)
+{
+	if (OldQuantity > 0)
+	{
+		const FQuantityIndexEntry OldEntry = { OldQuantity, Index };
+		const int32 Position = Algo::LowerBound(OwnedItemsByQuantity, OldEntry);
+		check(OwnedItemsByQuantity.IsValidIndex(Position) && OwnedItemsByQuantity[Position].Index == Index);
+		OwnedItemsByQuantity.RemoveAt(Position, 1, false);
+	}
+
+	if (NewQuantity > 0)
+	{
+		const FQuantityIndexEntry NewEntry = { NewQuantity, Index };
+		OwnedItemsByQuantity.Insert(NewEntry, Algo::LowerBound(OwnedItemsByQuantity, NewEntry));
+	}
+}
+
+void UInventory::UpdateOwnedByName(const int32 Index, const bool bOwned)
+{
+	// Stale orders are rebuilt on the next query. Ranks are only looked up
+	// while the catalog name indexes are built, so changing a quantity never
+	// pays for rebuilding them.
+	if (OwnedByNameVersion != Catalog->GetNameIndexVersion() || !Catalog->AreNameIndexesBuilt())
+		return;
+
+	const TConstArrayView<int32> NameRanks = Catalog->GetNameRanks();
+	const FInventoryItemId ItemId(Index);
+	const int32 Position = Algo::LowerBoundBy(OwnedItemsByName, NameRanks[Index], [NameRanks](const FInventoryItemId Owned) { return NameRanks[Owned.Index]; });
+
+	if (bOwned)
+	{
+		OwnedItemsByName.Insert(ItemId, Position);
+	}
+	else
+	{
+		check(OwnedItemsByName.IsValidIndex(Position) && OwnedItemsByName[Position] == ItemId);
+		OwnedItemsByName.RemoveAt(Position, 1, false);
+	}
+}
+
+void UInventory::RefreshOwnedByName() const
+{
+	if (!Catalog)
+		return;
+
+	// Ranks are only valid for the version they were looked up with
+	Catalog->BuildNameIndexes();
+	if (OwnedByNameVersion == Catalog->GetNameIndexVersion())
+		return;
+
+	OwnedItemsByName.Reset(OwnedItemsByQuantity.Num());
+	for (const FQuantityIndexEntry& Entry : OwnedItemsByQuantity)
+	{
+		OwnedItemsByName.Add(FInventoryItemId(Entry.Index));
+	}
+
+	OwnedItemsByName.Sort([this](const FInventoryItemId A, const FInventoryItemId B)
+	{
+		return Catalog->GetNameRank(A) < Catalog->GetNameRank(B);
+	});
+
+	OwnedByNameVersion = Catalog->GetNameIndexVersion();
+}
+
+int32 UInventory::GetInventoryPage(const InventorySortKey SortKey, const int32 StatId, const bool bDescending, 
+								const int32 Offset, const int32 Count, TArray<FInventoryItemId>& OutItems) const
+{
+	OutItems.Reset();
+
+	int32 NumInOrder = 0;
+
+	switch (SortKey)
+	{
+	case InventorySortKey::EName:
+		RefreshOwnedByName();
+		NumInOrder = OwnedItemsByName.Num();
+		break;
+	case InventorySortKey::EQuantity:
+		NumInOrder = OwnedItemsByQuantity.Num();
+		break;
+	case InventorySortKey::EStatBoost:
+		NumInOrder = GetOwnedItemsByStat(StatId).Num();
+		break;
+	}
+
+	const int32 First = FMath::Clamp(Offset, 0, NumInOrder);
+	const int32 Last = FMath::Clamp(First + FMath::Max(Count, 0), First, NumInOrder);
+	OutItems.Reserve(Last - First);
+
+	for (int32 Position = First; Position < Last; ++Position)
+	{
+		const int32 OrderPosition = bDescending ? NumInOrder - 1 - Position : Position;
+
+		switch (SortKey)
+		{
+		case InventorySortKey::EName:
+			OutItems.Add(OwnedItemsByName[OrderPosition]);
+			break;
+		case InventorySortKey::EQuantity:
+			OutItems.Add(FInventoryItemId(OwnedItemsByQuantity[OrderPosition].Index));
+			break;
+		case InventorySortKey::EStatBoost:
+			OutItems.Add(GetOwnedItemsByStat(StatId)[OrderPosition].ItemId);
+			break;
+		}
+	}
+
+	return NumInOrder;
+}
+
+TArray<FInventoryItem> UInventory::GetInventoryPage(const InventorySortKey SortKey, const FString& Stat, const bool bDescending, 
+													const int Offset, const int Count) const
+{
+	TArray<FInventoryItemId> ItemIds;
+	GetInventoryPage(SortKey, Catalog ? Catalog->FindStatId(Stat) : INDEX_NONE, bDescending, Offset, Count, ItemIds);
+
+	TArray<FInventoryItem> Items;
+	Items.SetNum(ItemIds.Num());
+	for (int32 Index = 0; Index < ItemIds.Num(); ++Index)
+	{
+		FillInventoryItem(ItemIds[Index].Index, Items[Index]);
+	}
+	return Items;
+}
+
+TConstArrayView<FInventoryStatIndexEntry> UInventory::GetOwnedItemsByStat(const int32 StatId, const InventoryItemFilter Filter /* = InventoryItemFilter::EAll */) const
+{
+	if (!OwnedItemsByStat.IsValidIndex(StatId))
+		return TConstArrayView<FInventoryStatIndexEntry>();
+
+	return OwnedItemsByStat[StatId].Entries[(int32)Filter];
+}
+
+FInventoryItemId UInventory::GetBestOwnedItemForStat(const FString& Stat, const InventoryItemFilter Filter /* = InventoryItemFilter::EAll */) const
+{
+	const TConstArrayView<FInventoryStatIndexEntry> Entries = GetOwnedItemsByStat(Catalog ? Catalog->FindStatId(Stat) : INDEX_NONE, Filter);
+	return Entries.Num() > 0 ? Entries[0].ItemId : FInventoryItemId();
+}
+
+TArray<FInventoryItemId> UInventory::GetOwnedItemsBoostingStat(const FString& Stat, const InventoryItemFilter Filter /* = InventoryItemFilter::EAll */) const
+{
+	const TConstArrayView<FInventoryStatIndexEntry> Entries = GetOwnedItemsByStat(Catalog ? Catalog->FindStatId(Stat) : INDEX_NONE, Filter);
+
+	TArray<FInventoryItemId> ItemIds;
+	ItemIds.Reserve(Entries.Num());
+	for (const FInventoryStatIndexEntry& Entry : Entries)
+	{
+		ItemIds.Add(Entry.ItemId);
+	}
+	return ItemIds;
+}
+
+TArray<FInventoryItemId> UInventory::SortItems(const FInventorySortOrder& Order) const
+{
+	TArray<FInventoryItemId> ItemIds;
+	ItemIds.Reserve(OwnedItemsByQuantity.Num());
+	for (const FQuantityIndexEntry& Entry : OwnedItemsByQuantity)
+	{
+		ItemIds.Add(FInventoryItemId(Entry.Index));
+	}
+
+	SortItems(Order, ItemIds);
+	return ItemIds;
+}
+
+void UInventory::SortItems(const FInventorySortOrder& Order, TArray<FInventoryItemId>& InOutItemIds) const
+{
+	if (Catalog)
+		FInventorySorter::Sort(*Catalog, Quantities, Order, InOutItemIds);
+}
+
+TArray<FInventoryItemId> UInventory::SearchItems(const FString& Query, const bool bPrefix /* = false */, const int MaxResults /* = 100 */) const
+{
+	TArray<FInventoryItemId> Items;
+	SearchItems(Query, bPrefix, MaxResults, Items);
+	return Items;
+}
+
+void UInventory::SearchItems(FStringView Query, const bool bPrefix, const int32 MaxResults, TArray<FInventoryItemId>& OutItems) const
+{
+	OutItems.Reset();
+
+	if (!Catalog || MaxResults <= 0)
+		return;
+
+	FString FoldedQuery;
+	UInventoryCatalog::FoldName(Query, FoldedQuery);
+
+	auto IsOwned = [this](const FInventoryItemId ItemId)
+	{
+		return Quantities.IsValidIndex(ItemId.Index) && Quantities[ItemId.Index] > 0;
+	};
+
+	auto Matches = [this, bPrefix, &FoldedQuery](const FInventoryItemId ItemId)
+	{
+		const FStringView FoldedName = Catalog->GetFoldedName(ItemId);
+		return bPrefix ? FoldedName.StartsWith(FoldedQuery, ESearchCase::CaseSensitive)
+			: FoldedName.Contains(FoldedQuery, ESearchCase::CaseSensitive);
+	};
+
+	// Walking a candidate list costs a quantity lookup per candidate, walking
+	// the owned items a name comparison per item, which costs about as much
+	// as this many lookups. Walk whichever is cheaper.
+	constexpr int32 NameCompareCost = 16;
+	const int32 OwnedWalkCost = OwnedItemsByQuantity.Num() * NameCompareCost;
+
+	// Keeps the first MaxResults matching owned items in the order of Less
+	auto MatchOwnedItems = [this, MaxResults, &OutItems, &Matches](auto Less)
+	{
+		for (const FQuantityIndexEntry& Entry : OwnedItemsByQuantity)
+		{
+			if (Matches(FInventoryItemId(Entry.Index)))
+				OutItems.Add(FInventoryItemId(Entry.Index));
+		}
+
+		OutItems.Sort(Less);
+		if (OutItems.Num() > MaxResults)
+			OutItems.SetNum(MaxResults, false);
+	};
+
+	auto ByItemId = [](const FInventoryItemId A, const FInventoryItemId B) { return A.Index < B.Index; };
+
+	if (bPrefix)
+	{
+		const TConstArrayView<FInventoryItemId> Candidates = Catalog->GetItemsByNamePrefix(FoldedQuery);
+		if (Candidates.Num() <= OwnedWalkCost)
+		{
+			for (const FInventoryItemId ItemId : Candidates)
+			{
+				if (IsOwned(ItemId) && OutItems.Add(ItemId) + 1 == MaxResults)
+					return;
+			}
+		}
+		else
+		{
+			const TConstArrayView<int32> NameRanks = Catalog->GetNameRanks();
+			MatchOwnedItems([NameRanks](const FInventoryItemId A, const FInventoryItemId B) { return NameRanks[A.Index] < NameRanks[B.Index]; });
+		}
+	}
+	else if (FoldedQuery.IsEmpty())
+	{
+		// Every owned item matches, quantities are in item id order
+		if (Quantities.Num() <= OwnedWalkCost)
+		{
+			for (int32 Index = 0; Index < Quantities.Num(); ++Index)
+			{
+				if (Quantities[Index] > 0 && OutItems.Add(FInventoryItemId(Index)) + 1 == MaxResults)
+					return;
+			}
+		}
+		else
+		{
+			MatchOwnedItems(ByItemId);
+		}
+	}
+	else
+	{
+		// Queries too short for the trigram index use the exact lists of
+		// items containing one or two characters instead
+		const bool bShortQuery = FoldedQuery.Len() < 3;
+		const TConstArrayView<FInventoryItemId> Candidates = bShortQuery ? Catalog->GetItemsByShortSequence(FoldedQuery)
+			: Catalog->GetItemsByNameTrigram(FoldedQuery);
+		if (Candidates.Num() <= OwnedWalkCost)
+		{
+			for (const FInventoryItemId ItemId : Candidates)
+			{
+				if (IsOwned(ItemId) && (bShortQuery || Matches(ItemId)) && OutItems.Add(ItemId) + 1 == MaxResults)
+					return;
+			}
+		}
+		else
+		{
+			MatchOwnedItems(ByItemId);
+		}
+	}
+}
+
+void UInventory::ApplyEquippedModifiers(const int32 Index, const int32 Sign)
+{
+	const TConstArrayView<FInventoryStatModifier> Modifiers = Catalog->GetModifiers(FInventoryItemId(Index));
+	if (Modifiers.Num() == 0)
+		return;
+
+	// Modifiers are sorted by stat id so the last one has the highest
+	const int32 MaxStatId = Modifiers.Last().StatId;
+	if (EquippedStatTotals.Num() <= MaxStatId)
+		EquippedStatTotals.AddZeroed(MaxStatId + 1 - EquippedStatTotals.Num());
+
+	for (const FInventoryStatModifier& Modifier : Modifiers)
+	{
+		EquippedStatTotals[Modifier.StatId] += Sign * Modifier.Boost;
+	}
+}
+
+void UInventory::StartConsumedBoosts(const int32 Index, const int32 Count)
+{
+	for (const FInventoryStatModifier& Modifier : Catalog->GetModifiers(FInventoryItemId(Index)))
+	{
+		// Periodic boosts are only delivered as pulses
+		if (Modifier.Period > 0)
+		{
+			if (WorldSubsystem)
+				WorldSubsystem->StartTimedBoost(this, FInventoryItemId(Index), Modifier, Count);
+			continue;
+		}
+
+		// A boost with a duration is only held once its expiry is scheduled,
+		// it would never end otherwise
+		if (Modifier.Duration <= 0 || (WorldSubsystem && WorldSubsystem->StartTimedBoost(this, FInventoryItemId(Index), Modifier, Count)))
+			AddToStatTotal(ActiveBoostTotals, Modifier.StatId, Modifier.Boost * Count);
+	}
+}
+
+void UInventory::HandleBoostEvents(TConstArrayView<FInventoryBoostEvent> Events)
+{
+	for (const FInventoryBoostEvent& Event : Events)
+	{
+		if (Event.bExpired && !Event.bPeriodic)
+			RemoveActiveBoost(Event.StatId, Event.Boost);
+	}
+
+	if (OnBoostEvents.IsBound())
+		OnBoostEvents.Broadcast(TArray<FInventoryBoostEvent>(Events.GetData(), Events.Num()));
+}
+
+void UInventory::RemoveActiveBoost(const int32 StatId, const int32 Boost)
+{
+	AddToStatTotal(ActiveBoostTotals, StatId, -Boost);
+}
+
+int UInventory::GetActiveBoostTotal(const FString& Stat) const
+{
+	return Catalog ? GetActiveBoostTotal(Catalog->FindStatId(Stat)) : 0;
+}
+
+FString UInventory::GetStatName(const int StatId) const
+{
+	return Catalog && StatId >= 0 && StatId < Catalog->NumStats() ? FString(Catalog->GetStatName(StatId)) : FString();
+}
+
+int UInventory::GetEquippedStatTotal(const FString& Stat) const
+{
+	return Catalog ? GetEquippedStatTotal(Catalog->FindStatId(Stat)) : 0;
+}
+
+void UInventory::RecomputeEquippedStatTotals(TArray<int32>& OutStatTotals) const
+{
+	OutStatTotals.Reset();
+	OutStatTotals.AddZeroed(Catalog ? Catalog->NumStats() : 0);
+
+	for (const FInventoryItemId ItemId : EquippedItemIds)
+	{
+		for (const FInventoryStatModifier& Modifier : Catalog->GetModifiers(ItemId))
+		{
+			OutStatTotals[Modifier.StatId] += Modifier.Boost;
+		}
+	}
+}
+
+bool UInventory::ValidateEquippedStatTotals() const
+{
+	TArray<int32> Recomputed;
+	RecomputeEquippedStatTotals(Recomputed);
+
+	// The incremental totals may be shorter, anything past their end must be 0
+	const int32 NumCommon = FMath::Min(Recomputed.Num(), EquippedStatTotals.Num());
+	if (FMemory::Memcmp(Recomputed.GetData(), EquippedStatTotals.GetData(), NumCommon * sizeof(int32)) != 0)
+		return false;
+
+	for (int32 StatId = NumCommon; StatId < Recomputed.Num(); ++StatId)
+	{
+		if (Recomputed[StatId] != 0)
+			return false;
+	}
+
+	return true;
+}
+
+void UInventory::MarkItemChanged(const int32 Index)
+{
+	++Generation;
+	ItemGenerations[Index] = Generation;
+	ChangeLog.Add({ Index, Generation });
+
+	// Nothing to do at the end of the frame without listeners or readers
+	if (PendingChanges.Num() > 0 || bPublishSnapshots)
+		MarkDirty();
+
+	// Once most of the log is stale compacting it is cheaper than keeping it
+	if (ChangeLog.Num() > FMath::Max(64, 2 * Quantities.Num()))
+		CompactChangeLog();
+}
+
+void UInventory::CompactChangeLog()
+{
+	ChangeLog.RemoveAll([this](const FChangeLogEntry& Entry)
+	{
+		return ItemGenerations[Entry.Index] != Entry.Generation;
+	});
+}
+
+int64 UInventory::GetChangesSince(const int64 SinceGeneration, TArray<FInventoryItemId>& OutChangedItems) const
+{
+	OutChangedItems.Reset();
+
+	for (int32 LogIndex = ChangeLog.Num() - 1; LogIndex >= 0 && ChangeLog[LogIndex].Generation > SinceGeneration; --LogIndex)
+	{
+		const FChangeLogEntry& Entry = ChangeLog[LogIndex];
+
+		// Only the latest entry of an item is reported
+		if (ItemGenerations[Entry.Index] == Entry.Generation)
+			OutChangedItems.Add(FInventoryItemId(Entry.Index));
+	}
+
+	return Generation;
+}
+
+void UInventory::RecordChange(const int32 Index)
+{
+	if (PendingChangeIndices[Index] != 0 || (!OnInventoryChanged.IsBound() && ItemSubscriptions.Num() == 0))
+		return;
+
+	FInventoryItemChange& Change = PendingChanges.AddDefaulted_GetRef();
+	Change.ItemId = FInventoryItemId(Index);
+	Change.OldQuantity = Quantities[Index];
+	Change.bOldEquipped = EquippedItems[Index];
+	PendingChangeIndices[Index] = PendingChanges.Num();
+}
+
+void UInventory::FlushChanges()
+{
+	if (PendingChanges.Num() == 0)
+		return;
+
+	// Changes made by listeners are recorded for the next frame
+	Swap(PendingChanges, FlushingChanges);
+	PendingChanges.Reset();
+
+	FlushingChanges.RemoveAll([this](FInventoryItemChange& Change)
+	{
+		const int32 Index = Change.ItemId.Index;
+		PendingChangeIndices[Index] = 0;
+		Change.NewQuantity = Quantities[Index];
+		Change.bNewEquipped = EquippedItems[Index];
+		return Change.NewQuantity == Change.OldQuantity && Change.bNewEquipped == Change.bOldEquipped;
+	});
+
+	if (ItemSubscriptions.Num() > 0)
+	{
+		for (const FInventoryItemChange& Change : FlushingChanges)
+		{
+			if (const TUniquePtr<FOnInventoryItemChanged>* Subscription = ItemSubscriptions.Find(Change.ItemId.Index))
+			{
+				FOnInventoryItemChanged& Delegate = **Subscription;
+				Delegate.Broadcast(Change);
+			}
+		}
+	}
+
+	if (FlushingChanges.Num() > 0 && OnInventoryChanged.IsBound())
+		OnInventoryChanged.Broadcast(FlushingChanges);
+}
+
+FDelegateHandle UInventory::SubscribeToItem(const FInventoryItemId ItemId, FOnInventoryItemChanged::FDelegate&& Delegate)
+{
+	TUniquePtr<FOnInventoryItemChanged>& Subscription = ItemSubscriptions.FindOrAdd(ItemId.Index);
+	if (!Subscription)
+		Subscription = MakeUnique<FOnInventoryItemChanged>();
+
+	return Subscription->Add(MoveTemp(Delegate));
+}
+
+void UInventory::UnsubscribeFromItem(const FInventoryItemId ItemId, const FDelegateHandle Handle)
+{
+	if (const TUniquePtr<FOnInventoryItemChanged>* Subscription = ItemSubscriptions.Find(ItemId.Index))
+		(*Subscription)->Remove(Handle);
+}
+
+void UInventory::MarkDirty()
+{
+	if (WorldSubsystem && DirtyIndex == INDEX_NONE)
+		WorldSubsystem->MarkInventoryDirty(this);
+}
+
+void UInventory::EnableSnapshots()
+{
+	bPublishSnapshots = true;
+	PublishSnapshot();
+}
+
+void UInventory::PublishSnapshot()
+{
+	if (!bPublishSnapshots || PublishedGeneration == Generation)
+		return;
+
+	TSharedRef<FInventorySnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FInventorySnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Generation = Generation;
+	Snapshot->Quantities = Quantities;
+	Snapshot->RegisteredItems = RegisteredItems;
+	Snapshot->EquippedItems = EquippedItems;
+
+	SnapshotPublisher.Publish(MoveTemp(Snapshot));
+	PublishedGeneration = Generation;
+}
+
+void UInventory::SaveState(TArray<uint8>& OutData) const
+{
+	auto IsSaved = [this](const int32 Index) { return Quantities[Index] != 0 || EquippedItems[Index]; };
+
+	int32 NumSaved = 0;
+	for (TConstSetBitIterator<> It(RegisteredItems); It; ++It)
+	{
+		if (IsSaved(It.GetIndex()))
+			++NumSaved;
+	}
+
+	OutData.Reset(24 + NumSaved * 3);
+	WriteFixed(OutData, SaveStateMagic, 4);
+	WriteVarint(OutData, SaveStateVersion);
+	WriteFixed(OutData, Catalog ? Catalog->GetFingerprint() : 0, 8);
+	WriteVarint(OutData, NumSaved);
+
+	int32 PreviousIndex = INDEX_NONE;
+	for (TConstSetBitIterator<> It(RegisteredItems); It; ++It)
+	{
+		const int32 Index = It.GetIndex();
+		if (!IsSaved(Index))
+			continue;
+
+		WriteVarint(OutData, Index - PreviousIndex - 1);
+		WriteVarint(OutData, (uint64(Quantities[Index]) << 1) | (EquippedItems[Index] ? 1 : 0));
+		PreviousIndex = Index;
+	}
+}
+
+bool UInventory::LoadState(TConstArrayView<uint8> Data)
+{
+	FSaveStateReader Reader{ Data };
+
+	uint64 Magic, Version, Fingerprint, NumSaved;
+	if (!Reader.ReadFixed(Magic, 4) || Magic != SaveStateMagic || !Reader.ReadVarint(Version))
+		return false;
+
+	// Older versions are migrated here as the format evolves
+	if (Version != SaveStateVersion)
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Cannot load inventory state of unknown version %llu"), Version);
+		return false;
+	}
+
+	if (!Reader.ReadFixed(Fingerprint, 8) || !Reader.ReadVarint(NumSaved))
+		return false;
+
+	if (Fingerprint != (Catalog ? Catalog->GetFingerprint() : 0))
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Cannot load inventory state saved against a different catalog"));
+		return false;
+	}
+
+	// Every entry takes at least two bytes
+	if (NumSaved > uint64(Data.Num() - Reader.Offset) / 2)
+		return false;
+
+	struct FSavedItem
+	{
+		int32 Index;
+		int32 Quantity;
+		bool bEquipped;
+	};
+
+	TArray<FSavedItem> SavedItems;
+	SavedItems.Reserve(int32(NumSaved));
+
+	// Validate everything before changing anything
+	int64 PreviousIndex = INDEX_NONE;
+	for (uint64 Entry = 0; Entry < NumSaved; ++Entry)
+	{
+		uint64 Delta, Value;
+		if (!Reader.ReadVarint(Delta) || !Reader.ReadVarint(Value) || Delta >= uint64(RegisteredItems.Num()))
+			return false;
+
+		const int64 Index = PreviousIndex + 1 + int64(Delta);
+		const uint64 Quantity = Value >> 1;
+		const bool bEquipped = (Value & 1) != 0;
+		const FInventoryItemId ItemId(int32(FMath::Min<int64>(Index, MAX_int32)));
+
+		if (!IsRegistered(ItemId)
+			|| Quantity > uint64(Catalog->GetMaximumQuantity(ItemId))
+			|| (bEquipped && !Catalog->IsEquippable(ItemId)))
+		{
+			return false;
+		}
+
+		SavedItems.Add({ ItemId.Index, int32(Quantity), bEquipped });
+		PreviousIndex = Index;
+	}
+
+	if (!Reader.IsAtEnd())
+		return false;
+
+	int32 SavedIndex = 0;
+	for (TConstSetBitIterator<> It(RegisteredItems); It; ++It)
+	{
+		const int32 Index = It.GetIndex();
+		const bool bIsSaved = SavedIndex < SavedItems.Num() && SavedItems[SavedIndex].Index == Index;
+
+		SetQuantity(Index, bIsSaved ? SavedItems[SavedIndex].Quantity : 0);
+		SetEquipped(Index, bIsSaved && SavedItems[SavedIndex].bEquipped);
+
+		if (bIsSaved)
+			++SavedIndex;
+	}
+
+	return true;
+}
+
+TArray<InventoryError> UInventory::AddItems(const TArray<FInventoryItemStack>& Items)
+{
+	TArray<InventoryError> Results;
+	Results.SetNumUninitialized(Items.Num());
+
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		Results[Index] = AddItem(ResolveItemId(Items[Index].ItemId, Items[Index].Name), Items[Index].Quantity);
+	}
+
+	return Results;
+}
+
+TArray<InventoryError> UInventory::ConsumeItems(const TArray<FInventoryItemStack>& Items)
+{
+	TArray<InventoryError> Results;
+	Results.SetNumUninitialized(Items.Num());
+
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		Results[Index] = ConsumeItem(ResolveItemId(Items[Index].ItemId, Items[Index].Name), Items[Index].Quantity);
+	}
+
+	return Results;
+}
+
+TArray<InventoryError> UInventory::ApplyOps(const TArray<FInventoryOp>& Ops)
+{
+	TArray<InventoryError> Results;
+	ApplyOps(TConstArrayView<FInventoryOp>(Ops), Results);
+	return Results;
+}
+
+void UInventory::ApplyOps(TConstArrayView<FInventoryOp> Ops, TArray<InventoryError>& OutResults)
+{
+	OutResults.SetNumUninitialized(Ops.Num());
+
+	for (int32 Index = 0; Index < Ops.Num(); ++Index)
+	{
+		const FInventoryOp& Op = Ops[Index];
+		OutResults[Index] = ApplyOp(Op.Type, ResolveItemId(Op.ItemId, Op.Name), Op.Quantity);
+	}
+}
+
+InventoryError UInventory::ApplyOpsAtomic(const TArray<FInventoryOp>& Ops)
+{
+	FInventoryTransaction Transaction = BeginTransaction();
+
+	for (const FInventoryOp& Op : Ops)
+	{
+		const FInventoryItemId ItemId = ResolveItemId(Op.ItemId, Op.Name);
+
+		InventoryError Result = InventoryError::EInvalidItemType;
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:
+			Result = Transaction.AddItem(ItemId, Op.Quantity);
+			break;
+		case InventoryOpType::EConsume:
+			Result = Transaction.ConsumeItem(ItemId, Op.Quantity);
+			break;
+		case InventoryOpType::EEquip:
+			Result = Transaction.EquipItem(ItemId);
+			break;
+		case InventoryOpType::EUnequip:
+			Result = Transaction.UnequipItem(ItemId);
+			break;
+		}
+
+		if (Result != InventoryError::ESuccess)
+			return Result;
+	}
+
+	return Transaction.Commit();
+}
+
+InventoryError UInventory::ApplyOp(const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity)
+{
+	switch (Type)
+	{
+	case InventoryOpType::EAdd:
+		return AddItem(ItemId, Quantity);
+	case InventoryOpType::EConsume:
+		return ConsumeItem(ItemId, Quantity);
+	case InventoryOpType::EEquip:
+		return EquipItem(ItemId);
+	case InventoryOpType::EUnequip:
+		return UnequipItem(ItemId);
+	default:
+		return InventoryError::EInvalidItemType;
+	}
+}
+
 TArray<FInventoryItem> UInventory::GetInventory()
 {
 	TArray<FInventoryItem> InventoryArray;
+	GetInventoryInto(InventoryArray);
+	return InventoryArray;
+}
+
+void UInventory::GetInventoryInto(TArray<FInventoryItem>& OutItems) const
+{
+	OutItems.SetNum(RegisteredItems.CountSetBits());
 
-	for (auto& Elem : Inventory)
+	int32 OutIndex = 0;
+	for (TConstSetBitIterator<> It(RegisteredItems); It; ++It)
 	{
-		InventoryArray.Add(Elem.Value);
+		FillInventoryItem(It.GetIndex(), OutItems[OutIndex++]);
 	}
+}
 
-	return InventoryArray;
+void UInventory::ForEachItem(TFunctionRef<void(const FInventoryItemView& Item)> Visitor) const
+{
+	for (TConstSetBitIterator<> It(RegisteredItems); It; ++It)
+	{
+		Visitor(MakeItemView(It.GetIndex()));
+	}
+}
+
+void UInventory::FillInventoryItem(const int32 Index, FInventoryItem& OutItem) const
+{
+	const FInventoryItemId ItemId(Index);
+
+	AssignString(OutItem.Name, Catalog->GetName(ItemId));
+	AssignString(OutItem.FlavorText, Catalog->GetFlavorText(ItemId));
+	OutItem.Thumbnail = Catalog->GetThumbnail(ItemId);
+	OutItem.FullImage = Catalog->GetFullImage(ItemId);
+	Catalog->GetStatsBoostsAndDurationsInto(ItemId, OutItem.StatsBoostsAndDurations);
+	OutItem.Quantity = Quantities[Index];
+	OutItem.MaximumQuantity = Catalog->GetMaximumQuantity(ItemId);
+	OutItem.IsEquippable = Catalog->IsEquippable(ItemId);
+	OutItem.IsEquipped = EquippedItems[Index];
+	OutItem.IsConsumable = Catalog->IsConsumable(ItemId);
+}
+
+FInventoryItemView UInventory::MakeItemView(const int32 Index) const
+{
+	const FInventoryItemId ItemId(Index);
+
+	FInventoryItemView View;
+	View.ItemId = ItemId;
+	View.Name = Catalog->GetName(ItemId);
+	View.FlavorText = Catalog->GetFlavorText(ItemId);
+	View.Modifiers = Catalog->GetModifiers(ItemId);
+	View.Quantity = Quantities[Index];
+	View.MaximumQuantity = Catalog->GetMaximumQuantity(ItemId);
+	View.bEquipped = EquippedItems[Index];
+	View.bEquippable = Catalog->IsEquippable(ItemId);
+	View.bConsumable = Catalog->IsConsumable(ItemId);
+	return View;
 }
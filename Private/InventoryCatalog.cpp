@@ -0,0 +1,590 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryCatalog.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "UObject/SoftObjectPath.h"
+#include "Engine/Texture2D.h"
+#include "InventorySystem.h"
+
+namespace
+{
+	uint32 HashModifierSet(const FInventoryModifierSet& Modifiers)
+	{
+		uint32 Hash = ::GetTypeHash(Modifiers.Num());
+		for (const FInventoryStatModifier& Modifier : Modifiers)
+		{
+			Hash = HashCombine(Hash, ::GetTypeHash(Modifier.StatId));
+			Hash = HashCombine(Hash, ::GetTypeHash(Modifier.Boost));
+			Hash = HashCombine(Hash, ::GetTypeHash(Modifier.Duration));
+			Hash = HashCombine(Hash, ::GetTypeHash(Modifier.Period));
+		}
+		return Hash;
+	}
+
+	uint64 MakeTrigram(const TCHAR* Chars)
+	{
+		return (uint64(Chars[0]) << 42) | (uint64(Chars[1]) << 21) | uint64(Chars[2]);
+	}
+
+	// Single characters and pairs share a map, pairs have the top bit set
+	uint64 MakeShortSequence(const TCHAR* Chars, const int32 Len)
+	{
+		return Len == 1 ? uint64(Chars[0]) : (uint64(1) << 63) | (uint64(Chars[0]) << 21) | uint64(Chars[1]);
+	}
+
+	// Adds an item to the list of a sequence of its name. Items are visited
+	// in id order, so a repeated sequence of the same name is always the 
+	// last entry.
+	void AddToSequence(TMap<uint64, TArray<FInventoryItemId>>& ItemsBySequence, const uint64 Sequence, const FInventoryItemId ItemId)
+	{
+		TArray<FInventoryItemId>& Items = ItemsBySequence.FindOrAdd(Sequence);
+		if (Items.Num() == 0 || Items.Last() != ItemId)
+			Items.Add(ItemId);
+	}
+}
+
+UInventoryCatalog::UInventoryCatalog()
+{
+	ModifierSets.AddDefaulted();
+	ModifierSetIds.Add(HashModifierSet(ModifierSets[0]), 0);
+}
+
+InventoryError UInventoryCatalog::AddItemType(FInventoryItemDefinition&& Definition, FInventoryItemId& OutItemId, 
+											const TBitArray<>* AllowedStats /* = nullptr */)
+{
+	const uint32 NameHash = GetTypeHash(Definition.Name);
+	const int32* ExistingRuntimeIndex = ItemIds.FindByHash(NameHash, Definition.Name);
+	const int32 ExistingIndex = ExistingRuntimeIndex ? *ExistingRuntimeIndex : Blob.FindItem(Definition.Name);
+
+	FInventoryModifierSet Modifiers;
+	const InventoryError Result = ResolveModifiers(Definition, AllowedStats, Modifiers);
+	if (Result != InventoryError::ESuccess)
+		return Result;
+
+	// Compare before interning, so a rejected definition leaves no modifier
+	// set behind that no item type uses
+	if (ExistingIndex != INDEX_NONE)
+	{
+		OutItemId = FInventoryItemId(ExistingIndex);
+		return IsIdenticalItemType(ExistingIndex, Definition, Modifiers) ? InventoryError::ESuccess : InventoryError::EDuplicateItemType;
+	}
+
+	const int32 ModifierSet = FindOrAddModifierSet(MoveTemp(Modifiers));
+
+	// The stats now live in the shared modifier set
+	Definition.StatsBoostsAndDurations.Empty();
+
+	const int32 Index = Num();
+	InvalidateDerivedData();
+	ItemIds.AddByHash(NameHash, Definition.Name, Index);
+	MaximumQuantities.Add(FMath::Max(Definition.MaximumQuantity, 0));
+	ConsumableItems.Add(Definition.IsConsumable);
+	EquippableItems.Add(Definition.IsEquippable);
+	ItemModifierSets.Add(ModifierSet);
+	Definitions.Add(MoveTemp(Definition));
+	OutItemId = FInventoryItemId(Index);
+
+	return InventoryError::ESuccess;
+}
+
+int32 UInventoryCatalog::AddItemTypes(TArrayView<FInventoryItemDefinition> NewDefinitions, TArray<FInventoryItemId>& OutItemIds, 
+									TArray<InventoryError>& OutResults, const TBitArray<>* AllowedStats /* = nullptr */)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	ReserveItemTypes(NewDefinitions.Num());
+
+	OutItemIds.Reset(NewDefinitions.Num());
+	OutResults.Reset(NewDefinitions.Num());
+
+	int32 NumSucceeded = 0;
+	for (FInventoryItemDefinition& Definition : NewDefinitions)
+	{
+		FInventoryItemId ItemId;
+		const InventoryError Result = AddItemType(MoveTemp(Definition), ItemId, AllowedStats);
+
+		OutItemIds.Add(ItemId);
+		OutResults.Add(Result);
+
+		if (Result == InventoryError::ESuccess)
+			++NumSucceeded;
+	}
+
+	UE_LOG(LogInventory, Log, TEXT("Registered %d of %d item types in %.2f ms (%d item types, %d modifier sets in catalog)"),
+		NumSucceeded, NewDefinitions.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0, Num(), NumModifierSets());
+
+	return NumSucceeded;
+}
+
+void UInventoryCatalog::ReserveItemTypes(const int32 NumItemTypes)
+{
+	const int32 MaxNum = Definitions.Num() + NumItemTypes;
+	Definitions.Reserve(MaxNum);
+	ItemIds.Reserve(MaxNum);
+	MaximumQuantities.Reserve(MaxNum);
+	ConsumableItems.Reserve(MaxNum);
+	EquippableItems.Reserve(MaxNum);
+	ItemModifierSets.Reserve(MaxNum);
+}
+
+bool UInventoryCatalog::IsIdenticalItemType(const int32 Index, const FInventoryItemDefinition& Definition, const FInventoryModifierSet& NewModifiers) const
+{
+	const FInventoryItemId ItemId(Index);
+
+	if (GetName(ItemId) != Definition.Name
+		|| GetFlavorText(ItemId) != Definition.FlavorText
+		|| GetMaximumQuantity(ItemId) != FMath::Max(Definition.MaximumQuantity, 0)
+		|| IsEquippable(ItemId) != Definition.IsEquippable
+		|| IsConsumable(ItemId) != Definition.IsConsumable)
+	{
+		return false;
+	}
+
+	// Compared by content, cooked item types do not share the runtime sets
+	const TConstArrayView<FInventoryStatModifier> Modifiers = GetModifiers(ItemId);
+	if (Modifiers.Num() != NewModifiers.Num() || !CompareItems(Modifiers.GetData(), NewModifiers.GetData(), Modifiers.Num()))
+		return false;
+
+	if (Index >= NumMappedItems)
+	{
+		const FInventoryItemDefinition& Existing = Definitions[Index - NumMappedItems];
+		return Existing.Thumbnail == Definition.Thumbnail && Existing.FullImage == Definition.FullImage;
+	}
+
+	// Images of cooked item types are only known by path
+	return GetThumbnailPath(ItemId) == FSoftObjectPath(Definition.Thumbnail).ToString()
+		&& GetFullImagePath(ItemId) == FSoftObjectPath(Definition.FullImage).ToString();
+}
+
+InventoryError UInventoryCatalog::ResolveModifiers(const FInventoryItemDefinition& Definition, const TBitArray<>* AllowedStats, FInventoryModifierSet& OutModifiers) const
+{
+	OutModifiers.Reset();
+	OutModifiers.Reserve(Definition.StatsBoostsAndDurations.Num());
+
+	for (const auto& Elem : Definition.StatsBoostsAndDurations)
+	{
+		const int32 StatId = FindStatId(Elem.Key);
+
+		if (StatId == INDEX_NONE || (AllowedStats && !(AllowedStats->IsValidIndex(StatId) && (*AllowedStats)[StatId])))
+			return InventoryError::EInvalidStatUsed;
+
+		FInventoryStatModifier& Modifier = OutModifiers.AddDefaulted_GetRef();
+		Modifier.StatId = StatId;
+		Modifier.Boost = Elem.Value.Boost;
+		Modifier.Duration = FMath::Max(Elem.Value.Duration, 0);
+		Modifier.Period = FMath::Max(Elem.Value.Period, 0);
+	}
+
+	OutModifiers.Sort([](const FInventoryStatModifier& A, const FInventoryStatModifier& B) { return A.StatId < B.StatId; });
+
+	return InventoryError::ESuccess;
+}
+
+FInventoryItemId UInventoryCatalog::FindItemId(FStringView Name) const
+{
+	const int32 MappedIndex = Blob.FindItem(Name);
+	if (MappedIndex != INDEX_NONE)
+		return FInventoryItemId(MappedIndex);
+
+	// Looked up by view, hashing and comparing like the FString keys, so
+	// resolving a name never allocates
+	if (const int32* Index = ItemIds.FindByHash(GetTypeHash(Name), Name))
+		return FInventoryItemId(*Index);
+
+	return FInventoryItemId();
+}
+
+int32 UInventoryCatalog::AddStat(const FString& StatName)
+{
+	const int32 ExistingStatId = FindStatId(StatName);
+	if (ExistingStatId != INDEX_NONE)
+		return ExistingStatId;
+
+	const int32 StatId = NumMappedStats + StatNames.Add(StatName);
+	StatIds.Add(StatName, StatId);
+	CachedFingerprint.Reset();
+	bItemsByStatValid = false;
+	return StatId;
+}
+
+int32 UInventoryCatalog::FindStatId(FStringView StatName) const
+{
+	const int32 MappedStatId = Blob.FindStat(StatName);
+	if (MappedStatId != INDEX_NONE)
+		return MappedStatId;
+
+	const int32* StatId = StatIds.FindByHash(GetTypeHash(StatName), StatName);
+	return StatId ? *StatId : INDEX_NONE;
+}
+
+TConstArrayView<FInventoryStatIndexEntry> UInventoryCatalog::GetItemsByStat(const int32 StatId) const
+{
+	if (StatId < 0 || StatId >= NumStats())
+		return TConstArrayView<FInventoryStatIndexEntry>();
+
+	if (!bItemsByStatValid)
+	{
+		ItemsByStat.Reset();
+		ItemsByStat.SetNum(NumStats());
+
+		for (int32 Index = 0; Index < Num(); ++Index)
+		{
+			for (const FInventoryStatModifier& Modifier : GetModifiers(FInventoryItemId(Index)))
+			{
+				ItemsByStat[Modifier.StatId].Add({ Modifier.Boost, FInventoryItemId(Index) });
+			}
+		}
+
+		for (TArray<FInventoryStatIndexEntry>& Entries : ItemsByStat)
+		{
+			Entries.Sort(&FInventoryStatIndexEntry::Precedes);
+		}
+
+		bItemsByStatValid = true;
+	}
+
+	return ItemsByStat[StatId];
+}
+
+void UInventoryCatalog::FoldName(FStringView Name, FString& OutFolded)
+{
+	OutFolded.Reset(Name.Len());
+	for (const TCHAR Char : Name)
+	{
+		OutFolded.AppendChar(FChar::ToLower(Char));
+	}
+}
+
+void UInventoryCatalog::BuildNameIndexes() const
+{
+	if (bNameIndexesValid)
+		return;
+
+	const int32 NumItems = Num();
+	FoldedNames.SetNum(NumItems);
+	ItemsByName.Reset(NumItems);
+	ItemsByTrigram.Reset();
+	ItemsByShortSequence.Reset();
+	CategoryRanks.SetNumUninitialized(NumItems);
+
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		const FInventoryItemId ItemId(Index);
+		FString& FoldedName = FoldedNames[Index];
+		FoldName(GetName(ItemId), FoldedName);
+		ItemsByName.Add(ItemId);
+		CategoryRanks[Index] = IsEquippable(ItemId) ? 0 : IsConsumable(ItemId) ? 1 : 2;
+
+		for (int32 Start = 0; Start < FoldedName.Len(); ++Start)
+		{
+			AddToSequence(ItemsByShortSequence, MakeShortSequence(*FoldedName + Start, 1), ItemId);
+
+			if (Start + 2 <= FoldedName.Len())
+				AddToSequence(ItemsByShortSequence, MakeShortSequence(*FoldedName + Start, 2), ItemId);
+
+			if (Start + 3 <= FoldedName.Len())
+				AddToSequence(ItemsByTrigram, MakeTrigram(*FoldedName + Start), ItemId);
+		}
+	}
+
+	ItemsByName.Sort([this](const FInventoryItemId A, const FInventoryItemId B)
+	{
+		return FoldedNames[A.Index].Compare(FoldedNames[B.Index], ESearchCase::CaseSensitive) < 0;
+	});
+
+	NameRanks.SetNumUninitialized(NumItems);
+	for (int32 Rank = 0; Rank < NumItems; ++Rank)
+	{
+		NameRanks[ItemsByName[Rank].Index] = Rank;
+	}
+
+	bNameIndexesValid = true;
+	++NameIndexVersion;
+}
+
+TConstArrayView<FInventoryItemId> UInventoryCatalog::GetItemsByNamePrefix(FStringView FoldedPrefix) const
+{
+	BuildNameIndexes();
+
+	auto StartsBefore = [this, FoldedPrefix](const FInventoryItemId ItemId)
+	{
+		const FStringView Name = FoldedNames[ItemId.Index];
+		return Name.Left(FoldedPrefix.Len()).Compare(FoldedPrefix, ESearchCase::CaseSensitive) < 0;
+	};
+
+	auto StartsWith = [this, FoldedPrefix](const FInventoryItemId ItemId)
+	{
+		return FStringView(FoldedNames[ItemId.Index]).StartsWith(FoldedPrefix, ESearchCase::CaseSensitive);
+	};
+
+	// Names starting with the prefix are contiguous in name order
+	int32 First = 0;
+	for (int32 Count = ItemsByName.Num(); Count > 0;)
+	{
+		const int32 Step = Count / 2;
+		if (StartsBefore(ItemsByName[First + Step]))
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	int32 Last = First;
+	for (int32 Count = ItemsByName.Num() - First; Count > 0;)
+	{
+		const int32 Step = Count / 2;
+		if (StartsWith(ItemsByName[Last + Step]))
+		{
+			Last += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+
+	return TConstArrayView<FInventoryItemId>(ItemsByName.GetData() + First, Last - First);
+}
+
+TConstArrayView<FInventoryItemId> UInventoryCatalog::GetItemsByNameTrigram(FStringView FoldedQuery) const
+{
+	BuildNameIndexes();
+
+	const TArray<FInventoryItemId>* Rarest = nullptr;
+	for (int32 Start = 0; Start + 3 <= FoldedQuery.Len(); ++Start)
+	{
+		const TArray<FInventoryItemId>* Items = ItemsByTrigram.Find(MakeTrigram(FoldedQuery.GetData() + Start));
+
+		// No name contains this trigram, so none contains the query
+		if (!Items)
+			return TConstArrayView<FInventoryItemId>();
+
+		if (!Rarest || Items->Num() < Rarest->Num())
+			Rarest = Items;
+	}
+
+	return Rarest ? TConstArrayView<FInventoryItemId>(*Rarest) : TConstArrayView<FInventoryItemId>();
+}
+
+TConstArrayView<FInventoryItemId> UInventoryCatalog::GetItemsByShortSequence(FStringView FoldedQuery) const
+{
+	BuildNameIndexes();
+
+	if (FoldedQuery.Len() < 1 || FoldedQuery.Len() > 2)
+		return TConstArrayView<FInventoryItemId>();
+
+	const TArray<FInventoryItemId>* Items = ItemsByShortSequence.Find(MakeShortSequence(FoldedQuery.GetData(), FoldedQuery.Len()));
+	return Items ? TConstArrayView<FInventoryItemId>(*Items) : TConstArrayView<FInventoryItemId>();
+}
+
+FStringView UInventoryCatalog::GetFoldedName(const FInventoryItemId ItemId) const
+{
+	BuildNameIndexes();
+	return FoldedNames[ItemId.Index];
+}
+
+int32 UInventoryCatalog::GetNameRank(const FInventoryItemId ItemId) const
+{
+	BuildNameIndexes();
+	return NameRanks[ItemId.Index];
+}
+
+TConstArrayView<int32> UInventoryCatalog::GetNameRanks() const
+{
+	BuildNameIndexes();
+	return NameRanks;
+}
+
+TConstArrayView<uint8> UInventoryCatalog::GetCategoryRanks() const
+{
+	BuildNameIndexes();
+	return CategoryRanks;
+}
+
+UTexture2D* UInventoryCatalog::GetThumbnail(const FInventoryItemId ItemId) const
+{
+	return ItemId.Index < NumMappedItems ? LoadMappedImage(ItemId.Index * 2, Blob.GetThumbnailPath(ItemId.Index))
+		: Definitions[ItemId.Index - NumMappedItems].Thumbnail;
+}
+
+UTexture2D* UInventoryCatalog::GetFullImage(const FInventoryItemId ItemId) const
+{
+	return ItemId.Index < NumMappedItems ? LoadMappedImage(ItemId.Index * 2 + 1, Blob.GetFullImagePath(ItemId.Index))
+		: Definitions[ItemId.Index - NumMappedItems].FullImage;
+}
+
+FString UInventoryCatalog::GetThumbnailPath(const FInventoryItemId ItemId) const
+{
+	return ItemId.Index < NumMappedItems ? FString(Blob.GetThumbnailPath(ItemId.Index))
+		: FSoftObjectPath(Definitions[ItemId.Index - NumMappedItems].Thumbnail).ToString();
+}
+
+FString UInventoryCatalog::GetFullImagePath(const FInventoryItemId ItemId) const
+{
+	return ItemId.Index < NumMappedItems ? FString(Blob.GetFullImagePath(ItemId.Index))
+		: FSoftObjectPath(Definitions[ItemId.Index - NumMappedItems].FullImage).ToString();
+}
+
+UTexture2D* UInventoryCatalog::LoadMappedImage(const int32 ImageIndex, FStringView Path) const
+{
+	if (Path.IsEmpty())
+		return nullptr;
+
+	if (UTexture2D* const* Image = MappedImages.Find(ImageIndex))
+		return *Image;
+
+	UTexture2D* Image = Cast<UTexture2D>(FSoftObjectPath(FString(Path)).TryLoad());
+	MappedImages.Add(ImageIndex, Image);
+	return Image;
+}
+
+bool UInventoryCatalog::LoadCookedCatalog(const FString& Filename, const bool bVerifyContents /* = false */)
+{
+	if (Num() > 0 || NumStats() > 0)
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Cannot load cooked catalog %s into a catalog that already has item types or stats"), *Filename);
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> NewMappedFile(PlatformFile.OpenMapped(*Filename));
+	TUniquePtr<IMappedFileRegion> NewMappedRegion;
+	if (NewMappedFile)
+		NewMappedRegion.Reset(NewMappedFile->MapRegion(0, NewMappedFile->GetFileSize()));
+
+	TArray<uint8> NewLoadedBlob;
+	const uint8* Data;
+	int64 Size;
+
+	if (NewMappedRegion)
+	{
+		Data = NewMappedRegion->GetMappedPtr();
+		Size = NewMappedRegion->GetMappedSize();
+	}
+	else
+	{
+		if (!FFileHelper::LoadFileToArray(NewLoadedBlob, *Filename))
+		{
+			UE_LOG(LogInventory, Warning, TEXT("Cannot read cooked catalog %s"), *Filename);
+			return false;
+		}
+
+		Data = NewLoadedBlob.GetData();
+		Size = NewLoadedBlob.Num();
+	}
+
+	FInventoryCatalogBlob NewBlob;
+	if (!NewBlob.Initialize(Data, Size, bVerifyContents))
+	{
+		UE_LOG(LogInventory, Warning, TEXT("%s is not a valid cooked catalog for this platform"), *Filename);
+		return false;
+	}
+
+	// The catalog is empty, so nothing is mapped yet. Only take over the new
+	// mapping once the blob is known to be valid.
+	MappedRegion = MoveTemp(NewMappedRegion);
+	MappedFile = MoveTemp(NewMappedFile);
+	LoadedBlob = MoveTemp(NewLoadedBlob);
+	Blob = NewBlob;
+	NumMappedItems = Blob.NumItems();
+	NumMappedStats = Blob.NumStats();
+	MappedImages.Reset();
+	InvalidateDerivedData();
+
+	UE_LOG(LogInventory, Log, TEXT("Loaded cooked catalog %s in %.2f ms (%d item types, %d stats, %s)"),
+		*Filename, (FPlatformTime::Seconds() - StartTime) * 1000.0, NumMappedItems, NumMappedStats, 
+		MappedRegion ? TEXT("mapped") : TEXT("read"));
+
+	return true;
+}
+
+void UInventoryCatalog::InvalidateDerivedData()
+{
+	CachedFingerprint.Reset();
+	bItemsByStatValid = false;
+	bNameIndexesValid = false;
+}
+
+bool UInventoryCatalog::SaveCookedCatalog(const FString& Filename) const
+{
+	TArray<uint8> CookedCatalog;
+	FInventoryCatalogBlob::Write(*this, CookedCatalog);
+	return FFileHelper::SaveArrayToFile(CookedCatalog, *Filename);
+}
+
+uint64 UInventoryCatalog::GetFingerprint() const
+{
+	if (!CachedFingerprint.IsSet())
+	{
+		if (Blob.IsValid() && Definitions.Num() == 0 && StatNames.Num() == 0)
+		{
+			CachedFingerprint = Blob.GetFingerprint();
+		}
+		else
+		{
+			TArray<uint8> CookedCatalog;
+			FInventoryCatalogBlob::Write(*this, CookedCatalog);
+
+			FInventoryCatalogBlob CookedBlob;
+			verify(CookedBlob.Initialize(CookedCatalog.GetData(), CookedCatalog.Num(), false));
+			CachedFingerprint = CookedBlob.GetFingerprint();
+		}
+	}
+
+	return CachedFingerprint.GetValue();
+}
+
+void UInventoryCatalog::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UInventoryCatalog* This = CastChecked<UInventoryCatalog>(InThis);
+	for (TPair<int32, UTexture2D*>& Image : This->MappedImages)
+	{
+		Collector.AddReferencedObject(Image.Value, This);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+TMap<FString, FBoostAndDuration> UInventoryCatalog::MakeStatsBoostsAndDurations(const FInventoryItemId ItemId) const
+{
+	TMap<FString, FBoostAndDuration> StatsBoostsAndDurations;
+	GetStatsBoostsAndDurationsInto(ItemId, StatsBoostsAndDurations);
+	return StatsBoostsAndDurations;
+}
+
+void UInventoryCatalog::GetStatsBoostsAndDurationsInto(const FInventoryItemId ItemId, TMap<FString, FBoostAndDuration>& OutStatsBoostsAndDurations) const
+{
+	OutStatsBoostsAndDurations.Reset();
+
+	for (const FInventoryStatModifier& Modifier : GetModifiers(ItemId))
+	{
+		FBoostAndDuration& BoostAndDuration = OutStatsBoostsAndDurations.Add(FString(GetStatName(Modifier.StatId)));
+		BoostAndDuration.Boost = Modifier.Boost;
+		BoostAndDuration.Duration = Modifier.Duration;
+		BoostAndDuration.Period = Modifier.Period;
+	}
+}
+
+int32 UInventoryCatalog::FindOrAddModifierSet(FInventoryModifierSet&& Modifiers)
+{
+	const uint32 Hash = HashModifierSet(Modifiers);
+
+	for (auto It = ModifierSetIds.CreateConstKeyIterator(Hash); It; ++It)
+	{
+		if (ModifierSets[It.Value()] == Modifiers)
+			return It.Value();
+	}
+
+	const int32 Index = ModifierSets.Add(MoveTemp(Modifiers));
+	ModifierSetIds.Add(Hash, Index);
+	return Index;
+}
@@ -0,0 +1,363 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryCatalogBlob.h"
+#include "Hash/CityHash.h"
+#include "InventoryCatalog.h"
+
+static_assert(sizeof(FInventoryStatModifier) == 16 && alignof(FInventoryStatModifier) == 4, 
+	"Cooked catalogs store FInventoryStatModifier in place, bump FInventoryCatalogBlob::Version when changing it");
+
+namespace
+{
+	constexpr uint64 SectionAlignment = 8;
+
+	template <typename T>
+	const T* GetSection(const uint8* Data, const uint64 Offset)
+	{
+		return reinterpret_cast<const T*>(Data + Offset);
+	}
+
+	bool IsSectionInBounds(const uint64 Offset, const uint64 Num, const uint64 ElementSize, const uint64 TotalSize)
+	{
+		return Offset % SectionAlignment == 0 && Offset <= TotalSize && Num <= (TotalSize - Offset) / ElementSize;
+	}
+
+	uint64 ComputeFingerprint(const uint8* Data, const FInventoryCatalogBlobHeader& Header)
+	{
+		const uint64 Seed = uint64(Header.NumItems) | (uint64(Header.NumStats) << 32);
+		return CityHash64WithSeed(reinterpret_cast<const char*>(Data) + sizeof(FInventoryCatalogBlobHeader),
+			uint32(Header.TotalSize - sizeof(FInventoryCatalogBlobHeader)), Seed);
+	}
+
+	// Linear probing lookup shared by the item and stat name tables
+	template <typename GetNameType>
+	int32 FindInTable(const uint32* Slots, const uint32 NumSlots, FStringView Name, GetNameType GetName)
+	{
+		if (NumSlots == 0)
+			return INDEX_NONE;
+
+		const uint32 Mask = NumSlots - 1;
+		for (uint32 Slot = FInventoryCatalogBlob::HashName(Name) & Mask, Probe = 0; Probe < NumSlots; Slot = (Slot + 1) & Mask, ++Probe)
+		{
+			const uint32 Entry = Slots[Slot];
+			if (Entry == 0)
+				return INDEX_NONE;
+
+			if (GetName(Entry - 1).Equals(Name, ESearchCase::IgnoreCase))
+				return Entry - 1;
+		}
+
+		return INDEX_NONE;
+	}
+
+	uint32 HashModifiers(TConstArrayView<FInventoryStatModifier> Modifiers)
+	{
+		return FCrc::MemCrc32(Modifiers.GetData(), Modifiers.Num() * sizeof(FInventoryStatModifier), Modifiers.Num());
+	}
+
+	void InsertInTable(TArray<uint32>& Slots, FStringView Name, const int32 Index)
+	{
+		const uint32 Mask = Slots.Num() - 1;
+		uint32 Slot = FInventoryCatalogBlob::HashName(Name) & Mask;
+		while (Slots[Slot] != 0)
+		{
+			Slot = (Slot + 1) & Mask;
+		}
+		Slots[Slot] = Index + 1;
+	}
+}
+
+uint32 FInventoryCatalogBlob::HashName(FStringView Name)
+{
+	// FNV-1a over upper cased characters, matching the case insensitivity of FString keys
+	uint32 Hash = 2166136261u;
+	for (const TCHAR Char : Name)
+	{
+		Hash = (Hash ^ uint32(FChar::ToUpper(Char))) * 16777619u;
+	}
+	return Hash;
+}
+
+bool FInventoryCatalogBlob::Initialize(const uint8* InData, const int64 InSize, const bool bVerifyContents)
+{
+	Header = nullptr;
+
+	if (!InData || InSize < int64(sizeof(FInventoryCatalogBlobHeader)) || !IsAligned(InData, SectionAlignment))
+		return false;
+
+	const FInventoryCatalogBlobHeader& NewHeader = *GetSection<FInventoryCatalogBlobHeader>(InData, 0);
+	const uint64 Size = uint64(InSize);
+	const uint64 NumBitWords = (uint64(NewHeader.NumItems) + 31) / 32;
+
+	if (NewHeader.Magic != Magic
+		|| NewHeader.Version != Version
+		|| NewHeader.CharSize != sizeof(TCHAR)
+		|| NewHeader.TotalSize != Size
+		|| !FMath::IsPowerOfTwo(NewHeader.NumItemSlots) || NewHeader.NumItemSlots <= NewHeader.NumItems
+		|| !FMath::IsPowerOfTwo(NewHeader.NumStatSlots) || NewHeader.NumStatSlots <= NewHeader.NumStats
+		|| !IsSectionInBounds(NewHeader.MaximumQuantitiesOffset, NewHeader.NumItems, sizeof(int32), Size)
+		|| !IsSectionInBounds(NewHeader.ConsumableBitsOffset, NumBitWords, sizeof(uint32), Size)
+		|| !IsSectionInBounds(NewHeader.EquippableBitsOffset, NumBitWords, sizeof(uint32), Size)
+		|| !IsSectionInBounds(NewHeader.ItemModifierSetsOffset, NewHeader.NumItems, sizeof(uint32), Size)
+		|| !IsSectionInBounds(NewHeader.ModifierSetsOffset, NewHeader.NumModifierSets, sizeof(FInventoryCatalogBlobRange), Size)
+		|| !IsSectionInBounds(NewHeader.ModifiersOffset, NewHeader.NumModifiers, sizeof(FInventoryStatModifier), Size)
+		|| !IsSectionInBounds(NewHeader.ItemStringsOffset, uint64(NewHeader.NumItems) * 4, sizeof(FInventoryCatalogBlobRange), Size)
+		|| !IsSectionInBounds(NewHeader.StatStringsOffset, NewHeader.NumStats, sizeof(FInventoryCatalogBlobRange), Size)
+		|| !IsSectionInBounds(NewHeader.ItemSlotsOffset, NewHeader.NumItemSlots, sizeof(uint32), Size)
+		|| !IsSectionInBounds(NewHeader.StatSlotsOffset, NewHeader.NumStatSlots, sizeof(uint32), Size)
+		|| !IsSectionInBounds(NewHeader.StringsOffset, NewHeader.StringsLength, sizeof(TCHAR), Size))
+	{
+		return false;
+	}
+
+	Header = &NewHeader;
+	MaximumQuantities = GetSection<int32>(InData, NewHeader.MaximumQuantitiesOffset);
+	ConsumableBits = GetSection<uint32>(InData, NewHeader.ConsumableBitsOffset);
+	EquippableBits = GetSection<uint32>(InData, NewHeader.EquippableBitsOffset);
+	ItemModifierSets = GetSection<uint32>(InData, NewHeader.ItemModifierSetsOffset);
+	ModifierSets = GetSection<FInventoryCatalogBlobRange>(InData, NewHeader.ModifierSetsOffset);
+	Modifiers = GetSection<FInventoryStatModifier>(InData, NewHeader.ModifiersOffset);
+	ItemStrings = GetSection<FInventoryCatalogBlobRange>(InData, NewHeader.ItemStringsOffset);
+	StatStrings = GetSection<FInventoryCatalogBlobRange>(InData, NewHeader.StatStringsOffset);
+	ItemSlots = GetSection<uint32>(InData, NewHeader.ItemSlotsOffset);
+	StatSlots = GetSection<uint32>(InData, NewHeader.StatSlotsOffset);
+	Strings = GetSection<TCHAR>(InData, NewHeader.StringsOffset);
+
+	if (bVerifyContents && (!VerifyContents() || ComputeFingerprint(InData, NewHeader) != NewHeader.Fingerprint))
+	{
+		Header = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool FInventoryCatalogBlob::VerifyContents() const
+{
+	auto IsValidString = [this](const FInventoryCatalogBlobRange& Range)
+	{
+		return Range.First <= Header->StringsLength && Range.Num <= Header->StringsLength - Range.First;
+	};
+
+	for (uint32 Set = 0; Set < Header->NumModifierSets; ++Set)
+	{
+		const FInventoryCatalogBlobRange& Range = ModifierSets[Set];
+		if (Range.First > Header->NumModifiers || Range.Num > Header->NumModifiers - Range.First)
+			return false;
+	}
+
+	for (uint32 Modifier = 0; Modifier < Header->NumModifiers; ++Modifier)
+	{
+		if (Modifiers[Modifier].StatId < 0 || uint32(Modifiers[Modifier].StatId) >= Header->NumStats)
+			return false;
+	}
+
+	for (uint32 Item = 0; Item < Header->NumItems; ++Item)
+	{
+		if (ItemModifierSets[Item] >= Header->NumModifierSets)
+			return false;
+
+		for (int32 String = 0; String < 4; ++String)
+		{
+			if (!IsValidString(ItemStrings[Item * 4 + String]))
+				return false;
+		}
+	}
+
+	for (uint32 Stat = 0; Stat < Header->NumStats; ++Stat)
+	{
+		if (!IsValidString(StatStrings[Stat]))
+			return false;
+	}
+
+	for (uint32 Slot = 0; Slot < Header->NumItemSlots; ++Slot)
+	{
+		if (ItemSlots[Slot] > Header->NumItems)
+			return false;
+	}
+
+	for (uint32 Slot = 0; Slot < Header->NumStatSlots; ++Slot)
+	{
+		if (StatSlots[Slot] > Header->NumStats)
+			return false;
+	}
+
+	return true;
+}
+
+TConstArrayView<FInventoryStatModifier> FInventoryCatalogBlob::GetModifiers(const int32 Index) const
+{
+	const FInventoryCatalogBlobRange& Range = ModifierSets[ItemModifierSets[Index]];
+	return TConstArrayView<FInventoryStatModifier>(Modifiers + Range.First, Range.Num);
+}
+
+int32 FInventoryCatalogBlob::FindItem(FStringView Name) const
+{
+	if (!Header)
+		return INDEX_NONE;
+
+	return FindInTable(ItemSlots, Header->NumItemSlots, Name, [this](const int32 Index) { return GetName(Index); });
+}
+
+int32 FInventoryCatalogBlob::FindStat(FStringView Name) const
+{
+	if (!Header)
+		return INDEX_NONE;
+
+	return FindInTable(StatSlots, Header->NumStatSlots, Name, [this](const int32 StatId) { return GetStatName(StatId); });
+}
+
+void FInventoryCatalogBlob::Write(const UInventoryCatalog& Catalog, TArray<uint8>& OutBlob)
+{
+	const int32 NumItems = Catalog.Num();
+	const int32 NumStats = Catalog.NumStats();
+	const int32 NumBitWords = (NumItems + 31) / 32;
+
+	TArray<int32> MaximumQuantityData;
+	TArray<uint32> ConsumableBitData;
+	TArray<uint32> EquippableBitData;
+	TArray<uint32> ItemModifierSetData;
+	TArray<FInventoryCatalogBlobRange> ModifierSetData;
+	TArray<FInventoryStatModifier> ModifierData;
+	TArray<FInventoryCatalogBlobRange> ItemStringData;
+	TArray<FInventoryCatalogBlobRange> StatStringData;
+	TArray<TCHAR> StringData;
+
+	MaximumQuantityData.Reserve(NumItems);
+	ConsumableBitData.AddZeroed(NumBitWords);
+	EquippableBitData.AddZeroed(NumBitWords);
+	ItemModifierSetData.Reserve(NumItems);
+	ItemStringData.Reserve(NumItems * 4);
+	StatStringData.Reserve(NumStats);
+
+	auto AddString = [&StringData](FStringView String)
+	{
+		const FInventoryCatalogBlobRange Range = { uint32(StringData.Num()), uint32(String.Len()) };
+		StringData.Append(String.GetData(), String.Len());
+		return Range;
+	};
+
+	// Modifier sets are deduplicated by content
+	TMultiMap<uint32, int32> ModifierSetsByHash;
+
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		const FInventoryItemId ItemId(Index);
+
+		MaximumQuantityData.Add(Catalog.GetMaximumQuantity(ItemId));
+
+		if (Catalog.IsConsumable(ItemId))
+			ConsumableBitData[Index >> 5] |= 1u << (Index & 31);
+
+		if (Catalog.IsEquippable(ItemId))
+			EquippableBitData[Index >> 5] |= 1u << (Index & 31);
+
+		const TConstArrayView<FInventoryStatModifier> Modifiers = Catalog.GetModifiers(ItemId);
+		const uint32 Hash = HashModifiers(Modifiers);
+
+		int32 ModifierSet = INDEX_NONE;
+		for (auto It = ModifierSetsByHash.CreateConstKeyIterator(Hash); It; ++It)
+		{
+			const FInventoryCatalogBlobRange& Range = ModifierSetData[It.Value()];
+			if (Range.Num == Modifiers.Num() && CompareItems(ModifierData.GetData() + Range.First, Modifiers.GetData(), Modifiers.Num()))
+			{
+				ModifierSet = It.Value();
+				break;
+			}
+		}
+
+		if (ModifierSet == INDEX_NONE)
+		{
+			ModifierSet = ModifierSetData.Add({ uint32(ModifierData.Num()), uint32(Modifiers.Num()) });
+			ModifierData.Append(Modifiers.GetData(), Modifiers.Num());
+			ModifierSetsByHash.Add(Hash, ModifierSet);
+		}
+
+		ItemModifierSetData.Add(ModifierSet);
+
+		ItemStringData.Add(AddString(Catalog.GetName(ItemId)));
+		ItemStringData.Add(AddString(Catalog.GetFlavorText(ItemId)));
+		ItemStringData.Add(AddString(Catalog.GetThumbnailPath(ItemId)));
+		ItemStringData.Add(AddString(Catalog.GetFullImagePath(ItemId)));
+	}
+
+	for (int32 StatId = 0; StatId < NumStats; ++StatId)
+	{
+		StatStringData.Add(AddString(Catalog.GetStatName(StatId)));
+	}
+
+	// Name tables at most half full
+	TArray<uint32> ItemSlotData;
+	ItemSlotData.AddZeroed(FMath::RoundUpToPowerOfTwo(uint32(NumItems) * 2 + 1));
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		InsertInTable(ItemSlotData, Catalog.GetName(FInventoryItemId(Index)), Index);
+	}
+
+	TArray<uint32> StatSlotData;
+	StatSlotData.AddZeroed(FMath::RoundUpToPowerOfTwo(uint32(NumStats) * 2 + 1));
+	for (int32 StatId = 0; StatId < NumStats; ++StatId)
+	{
+		InsertInTable(StatSlotData, Catalog.GetStatName(StatId), StatId);
+	}
+
+	// Lay out the sections
+	FInventoryCatalogBlobHeader Header;
+	FMemory::Memzero(Header);
+
+	uint64 Offset = sizeof(FInventoryCatalogBlobHeader);
+	auto PlaceSection = [&Offset](const uint64 NumBytes)
+	{
+		const uint64 SectionOffset = Align(Offset, SectionAlignment);
+		Offset = SectionOffset + NumBytes;
+		return SectionOffset;
+	};
+
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.CharSize = sizeof(TCHAR);
+	Header.NumItems = NumItems;
+	Header.NumStats = NumStats;
+	Header.NumModifierSets = ModifierSetData.Num();
+	Header.NumModifiers = ModifierData.Num();
+	Header.NumItemSlots = ItemSlotData.Num();
+	Header.NumStatSlots = StatSlotData.Num();
+	Header.MaximumQuantitiesOffset = PlaceSection(MaximumQuantityData.Num() * sizeof(int32));
+	Header.ConsumableBitsOffset = PlaceSection(ConsumableBitData.Num() * sizeof(uint32));
+	Header.EquippableBitsOffset = PlaceSection(EquippableBitData.Num() * sizeof(uint32));
+	Header.ItemModifierSetsOffset = PlaceSection(ItemModifierSetData.Num() * sizeof(uint32));
+	Header.ModifierSetsOffset = PlaceSection(ModifierSetData.Num() * sizeof(FInventoryCatalogBlobRange));
+	Header.ModifiersOffset = PlaceSection(ModifierData.Num() * sizeof(FInventoryStatModifier));
+	Header.ItemStringsOffset = PlaceSection(ItemStringData.Num() * sizeof(FInventoryCatalogBlobRange));
+	Header.StatStringsOffset = PlaceSection(StatStringData.Num() * sizeof(FInventoryCatalogBlobRange));
+	Header.ItemSlotsOffset = PlaceSection(ItemSlotData.Num() * sizeof(uint32));
+	Header.StatSlotsOffset = PlaceSection(StatSlotData.Num() * sizeof(uint32));
+	Header.StringsOffset = PlaceSection(StringData.Num() * sizeof(TCHAR));
+	Header.StringsLength = StringData.Num();
+	Header.TotalSize = Align(Offset, SectionAlignment);
+
+	OutBlob.Reset();
+	OutBlob.AddZeroed(Header.TotalSize);
+
+	auto CopySection = [&OutBlob](const uint64 SectionOffset, const void* Data, const uint64 NumBytes)
+	{
+		if (NumBytes > 0)
+			FMemory::Memcpy(OutBlob.GetData() + SectionOffset, Data, NumBytes);
+	};
+
+	CopySection(Header.MaximumQuantitiesOffset, MaximumQuantityData.GetData(), MaximumQuantityData.Num() * sizeof(int32));
+	CopySection(Header.ConsumableBitsOffset, ConsumableBitData.GetData(), ConsumableBitData.Num() * sizeof(uint32));
+	CopySection(Header.EquippableBitsOffset, EquippableBitData.GetData(), EquippableBitData.Num() * sizeof(uint32));
+	CopySection(Header.ItemModifierSetsOffset, ItemModifierSetData.GetData(), ItemModifierSetData.Num() * sizeof(uint32));
+	CopySection(Header.ModifierSetsOffset, ModifierSetData.GetData(), ModifierSetData.Num() * sizeof(FInventoryCatalogBlobRange));
+	CopySection(Header.ModifiersOffset, ModifierData.GetData(), ModifierData.Num() * sizeof(FInventoryStatModifier));
+	CopySection(Header.ItemStringsOffset, ItemStringData.GetData(), ItemStringData.Num() * sizeof(FInventoryCatalogBlobRange));
+	CopySection(Header.StatStringsOffset, StatStringData.GetData(), StatStringData.Num() * sizeof(FInventoryCatalogBlobRange));
+	CopySection(Header.ItemSlotsOffset, ItemSlotData.GetData(), ItemSlotData.Num() * sizeof(uint32));
+	CopySection(Header.StatSlotsOffset, StatSlotData.GetData(), StatSlotData.Num() * sizeof(uint32));
+	CopySection(Header.StringsOffset, StringData.GetData(), StringData.Num() * sizeof(TCHAR));
+
+	Header.Fingerprint = ComputeFingerprint(OutBlob.GetData(), Header);
+	FMemory::Memcpy(OutBlob.GetData(), &Header, sizeof(Header));
+}
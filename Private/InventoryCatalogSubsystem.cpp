@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryCatalogSubsystem.h"
+#include "InventoryCatalog.h"
+#include "Misc/Paths.h"
+
+void UInventoryCatalogSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Catalog = NewObject<UInventoryCatalog>(this);
+
+	if (!CookedCatalogFile.IsEmpty())
+	{
+		// Shipping builds trust their own cooked data
+		Catalog->LoadCookedCatalog(FPaths::Combine(FPaths::ProjectDir(), CookedCatalogFile), !UE_BUILD_SHIPPING);
+	}
+}
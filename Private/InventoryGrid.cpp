@@ -0,0 +1,421 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryGrid.h"
+#include "GameFramework/Actor.h"
+#include "Inventory.h"
+#include "InventorySystem.h"
+
+UInventoryGrid::UInventoryGrid()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UInventoryGrid::OnRegister()
+{
+	Super::OnRegister();
+
+	ResetRows();
+}
+
+// Called when the game starts
+void UInventoryGrid::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Inventory = GetOwner() ? GetOwner()->FindComponentByClass<UInventory>() : nullptr;
+	if (!Inventory)
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Inventory grid %s has no inventory to lay out"), *GetPathName());
+		return;
+	}
+
+	Inventory->OnInventoryChanged.AddDynamic(this, &UInventoryGrid::HandleInventoryChanged);
+
+	// Lay out what the inventory already holds, largest first. Arrange only
+	// reads the sizes of the placements, so they start out unplaced.
+	Inventory->ForEachItem([this](const FInventoryItemView& Item)
+	{
+		if (Item.Quantity > 0)
+		{
+			FInventoryGridPlacement& Placement = Placements.AddDefaulted_GetRef();
+			Placement.ItemId = Item.ItemId;
+			Placement.Size = GetItemFootprint(Item.ItemId);
+		}
+	});
+
+	if (Placements.Num() > 0 && !Arrange(FInventoryItemId()))
+	{
+		// Keep what fits in the order the inventory holds it
+		TArray<FInventoryGridPlacement> Pending = MoveTemp(Placements);
+		ResetRows();
+
+		for (const FInventoryGridPlacement& Placement : Pending)
+		{
+			if (!PlaceItem(Placement.ItemId))
+				UE_LOG(LogInventory, Warning, TEXT("No space in inventory grid %s for item %d"), *GetPathName(), Placement.ItemId.Index);
+		}
+	}
+}
+
+// Called when the game ends or the component is destroyed
+void UInventoryGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Inventory)
+		Inventory->OnInventoryChanged.RemoveDynamic(this, &UInventoryGrid::HandleInventoryChanged);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+InventoryError UInventoryGrid::SetItemFootprint(const FString& Item, const FIntPoint Size)
+{
+	const FInventoryItemId ItemId = Inventory ? Inventory->FindItemId(Item) : FInventoryItemId();
+	if (!ItemId.IsValid())
+		return InventoryError::EInvalidItemType;
+
+	SetItemFootprint(ItemId, Size);
+	return InventoryError::ESuccess;
+}
+
+void UInventoryGrid::SetItemFootprint(const FInventoryItemId ItemId, const FIntPoint Size)
+{
+	const FIntPoint Clamped(FMath::Clamp(Size.X, 1, MaxWidth), FMath::Max(Size.Y, 1));
+	if (Clamped == FIntPoint(1, 1))
+		Footprints.Remove(ItemId.Index);
+	else
+		Footprints.Add(ItemId.Index, Clamped);
+}
+
+FIntPoint UInventoryGrid::GetItemFootprint(const FInventoryItemId ItemId) const
+{
+	const FIntPoint* Size = Footprints.Find(ItemId.Index);
+	return Size ? *Size : FIntPoint(1, 1);
+}
+
+InventoryError UInventoryGrid::AddItem(const FString& ItemToAdd, const int Quantity)
+{
+	if (!Inventory)
+		return InventoryError::EInvalidItemType;
+
+	return AddItem(Inventory->FindItemId(ItemToAdd), Quantity);
+}
+
+InventoryError UInventoryGrid::AddItem(const FInventoryItemId ItemToAdd, const int Quantity)
+{
+	if (!Inventory)
+		return InventoryError::EInvalidItemType;
+
+	// Only a new item type needs space. Check the inventory takes the items
+	// before placing them, placing may rearrange the whole grid and a failed
+	// add must leave it as it was.
+	const int32 CurrentQuantity = Inventory->GetItemQuantity(ItemToAdd);
+	if (!PlacementIndices.Contains(ItemToAdd.Index) && CurrentQuantity + Quantity > 0)
+	{
+		if (!Inventory->IsRegistered(ItemToAdd))
+			return InventoryError::EInvalidItemType;
+
+		if (CurrentQuantity + Quantity > Inventory->GetCatalog()->GetMaximumQuantity(ItemToAdd))
+			return InventoryError::EMaxQuantityExceeded;
+
+		if (!PlaceItem(ItemToAdd))
+			return InventoryError::ENoSpace;
+	}
+
+	return Inventory->AddItem(ItemToAdd, Quantity);
+}
+
+bool UInventoryGrid::CanFitItem(const FString& Item) const
+{
+	return Inventory && CanFitItem(Inventory->FindItemId(Item));
+}
+
+bool UInventoryGrid::CanFitItem(const FInventoryItemId ItemId) const
+{
+	if (PlacementIndices.Contains(ItemId.Index))
+		return true;
+
+	FIntPoint Position;
+	return ItemId.IsValid() && FindFirstFit(GetItemFootprint(ItemId), Position);
+}
+
+bool UInventoryGrid::IsAreaFree(const FIntPoint Position, const FIntPoint Size) const
+{
+	if (Position.X < 0 || Position.Y < 0 || Size.X < 1 || Size.Y < 1
+		|| Position.X + Size.X > Width || Position.Y + Size.Y > Rows.Num())
+		return false;
+
+	const uint64 Mask = RowMask(Size.X) << Position.X;
+	for (int32 Y = Position.Y; Y < Position.Y + Size.Y; ++Y)
+	{
+		if (Rows[Y] & Mask)
+			return false;
+	}
+
+	return true;
+}
+
+bool UInventoryGrid::FindCandidates(const FIntPoint Size, TArray<uint64, TInlineAllocator<64>>& OutCandidates) const
+{
+	if (Size.X < 1 || Size.Y < 1 || Size.X > Width || Size.Y > Rows.Num())
+		return false;
+
+	// Bit X of a row's runs is set while cells X to X + Length - 1 are all
+	// free. Each step ANDs the runs with themselves shifted by up to their
+	// length, so a run of Size.X cells takes log2(Size.X) steps.
+	const uint64 GridMask = RowMask(Width);
+	OutCandidates.SetNumUninitialized(Rows.Num());
+	for (int32 Y = 0; Y < Rows.Num(); ++Y)
+	{
+		uint64 Runs = ~Rows[Y] & GridMask;
+		for (int32 Length = 1; Length < Size.X && Runs;)
+		{
+			const int32 Step = FMath::Min(Length, Size.X - Length);
+			Runs &= Runs >> Step;
+			Length += Step;
+		}
+		OutCandidates[Y] = Runs;
+	}
+
+	// The same doubling down the columns, word Y then holds the columns
+	// where rows Y to Y + Size.Y - 1 all have a run
+	int32 NumCandidateRows = Rows.Num();
+	for (int32 Length = 1; Length < Size.Y;)
+	{
+		const int32 Step = FMath::Min(Length, Size.Y - Length);
+		NumCandidateRows -= Step;
+		for (int32 Y = 0; Y < NumCandidateRows; ++Y)
+		{
+			OutCandidates[Y] &= OutCandidates[Y + Step];
+		}
+		Length += Step;
+	}
+
+	OutCandidates.SetNum(NumCandidateRows, false);
+	return true;
+}
+
+bool UInventoryGrid::FindFirstFit(const FIntPoint Size, FIntPoint& OutPosition) const
+{
+	TArray<uint64, TInlineAllocator<64>> Candidates;
+	if (!FindCandidates(Size, Candidates))
+		return false;
+
+	for (int32 Y = 0; Y < Candidates.Num(); ++Y)
+	{
+		if (Candidates[Y])
+		{
+			OutPosition = FIntPoint(int32(FPlatformMath::CountTrailingZeros64(Candidates[Y])), Y);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UInventoryGrid::FindBestFit(const FIntPoint Size, FIntPoint& OutPosition) const
+{
+	TArray<uint64, TInlineAllocator<64>> Candidates;
+	if (!FindCandidates(Size, Candidates))
+		return false;
+
+	int32 BestContacts = -1;
+	for (int32 Y = 0; Y < Candidates.Num(); ++Y)
+	{
+		for (uint64 Bits = Candidates[Y]; Bits; Bits &= Bits - 1)
+		{
+			const FIntPoint Position(int32(FPlatformMath::CountTrailingZeros64(Bits)), Y);
+			const int32 Contacts = CountContacts(Position, Size);
+			if (Contacts > BestContacts)
+			{
+				BestContacts = Contacts;
+				OutPosition = Position;
+			}
+		}
+	}
+
+	return BestContacts >= 0;
+}
+
+int32 UInventoryGrid::CountContacts(const FIntPoint Position, const FIntPoint Size) const
+{
+	const uint64 Mask = RowMask(Size.X) << Position.X;
+	const int32 Bottom = Position.Y + Size.Y;
+
+	int32 Contacts = 0;
+	Contacts += Position.Y == 0 ? Size.X : int32(FPlatformMath::CountBits(Rows[Position.Y - 1] & Mask));
+	Contacts += Bottom == Rows.Num() ? Size.X : int32(FPlatformMath::CountBits(Rows[Bottom] & Mask));
+
+	// The columns left and right of the rectangle, one bit per row
+	const bool bLeftBorder = Position.X == 0;
+	const bool bRightBorder = Position.X + Size.X == Width;
+	const uint64 LeftBit = bLeftBorder ? 0 : uint64(1) << (Position.X - 1);
+	const uint64 RightBit = bRightBorder ? 0 : uint64(1) << (Position.X + Size.X);
+	for (int32 Y = Position.Y; Y < Bottom; ++Y)
+	{
+		Contacts += (bLeftBorder || (Rows[Y] & LeftBit) != 0) + (bRightBorder || (Rows[Y] & RightBit) != 0);
+	}
+
+	return Contacts;
+}
+
+void UInventoryGrid::SetCells(const FIntPoint Position, const FIntPoint Size, const bool bOccupied)
+{
+	const uint64 Mask = RowMask(Size.X) << Position.X;
+	for (int32 Y = Position.Y; Y < Position.Y + Size.Y; ++Y)
+	{
+		Rows[Y] = bOccupied ? Rows[Y] | Mask : Rows[Y] & ~Mask;
+	}
+}
+
+bool UInventoryGrid::MoveItem(const FInventoryItemId ItemId, const FIntPoint Position)
+{
+	const int32* PlacementIndex = PlacementIndices.Find(ItemId.Index);
+	if (!PlacementIndex)
+		return false;
+
+	FInventoryGridPlacement& Placement = Placements[*PlacementIndex];
+	SetCells(Placement.Position, Placement.Size, false);
+
+	const bool bFree = IsAreaFree(Position, Placement.Size);
+	if (bFree)
+		Placement.Position = Position;
+
+	SetCells(Placement.Position, Placement.Size, true);
+	return bFree;
+}
+
+bool UInventoryGrid::AutoArrange()
+{
+	return Arrange(FInventoryItemId());
+}
+
+bool UInventoryGrid::Arrange(const FInventoryItemId ExtraItemId)
+{
+	TArray<FInventoryGridPlacement> Arranged = Placements;
+	if (ExtraItemId.IsValid())
+	{
+		FInventoryGridPlacement& Extra = Arranged.AddDefaulted_GetRef();
+		Extra.ItemId = ExtraItemId;
+		Extra.Size = GetItemFootprint(ExtraItemId);
+	}
+
+	// Largest first, the taller of equal areas first, then by item id so
+	// the layout only depends on what is placed
+	Arranged.Sort([](const FInventoryGridPlacement& A, const FInventoryGridPlacement& B)
+	{
+		const int32 AreaA = A.Size.X * A.Size.Y;
+		const int32 AreaB = B.Size.X * B.Size.Y;
+		if (AreaA != AreaB)
+			return AreaA > AreaB;
+		if (A.Size.Y != B.Size.Y)
+			return A.Size.Y > B.Size.Y;
+		return A.ItemId.Index < B.ItemId.Index;
+	});
+
+	TArray<uint64> OldRows = Rows;
+	ResetRows();
+
+	for (FInventoryGridPlacement& Placement : Arranged)
+	{
+		if (!FindBestFit(Placement.Size, Placement.Position))
+		{
+			Rows = MoveTemp(OldRows);
+			return false;
+		}
+		SetCells(Placement.Position, Placement.Size, true);
+	}
+
+	Placements = MoveTemp(Arranged);
+	PlacementIndices.Reset();
+	for (int32 PlacementIndex = 0; PlacementIndex < Placements.Num(); ++PlacementIndex)
+	{
+		PlacementIndices.Add(Placements[PlacementIndex].ItemId.Index, PlacementIndex);
+	}
+
+	return true;
+}
+
+FInventoryItemId UInventoryGrid::GetItemAt(const FIntPoint Cell) const
+{
+	if (!IsAreaFree(Cell, FIntPoint(1, 1)))
+	{
+		for (const FInventoryGridPlacement& Placement : Placements)
+		{
+			if (Cell.X >= Placement.Position.X && Cell.X < Placement.Position.X + Placement.Size.X
+				&& Cell.Y >= Placement.Position.Y && Cell.Y < Placement.Position.Y + Placement.Size.Y)
+				return Placement.ItemId;
+		}
+	}
+
+	return FInventoryItemId();
+}
+
+const FInventoryGridPlacement* UInventoryGrid::FindPlacement(const FInventoryItemId ItemId) const
+{
+	const int32* PlacementIndex = PlacementIndices.Find(ItemId.Index);
+	return PlacementIndex ? &Placements[*PlacementIndex] : nullptr;
+}
+
+void UInventoryGrid::HandleInventoryChanged(const TArray<FInventoryItemChange>& Changes)
+{
+	for (const FInventoryItemChange& Change : Changes)
+	{
+		// Negative quantities count as none and take no space
+		if (FMath::Max(Change.NewQuantity, 0) == 0)
+		{
+			RemovePlacement(Change.ItemId);
+		}
+		else if (!PlacementIndices.Contains(Change.ItemId.Index) && !PlaceItem(Change.ItemId))
+		{
+			UE_LOG(LogInventory, Warning, TEXT("No space in inventory grid %s for item %d"), *GetPathName(), Change.ItemId.Index);
+		}
+	}
+}
+
+void UInventoryGrid::ResetRows()
+{
+	Width = FMath::Clamp(Width, 1, MaxWidth);
+	Height = FMath::Max(Height, 1);
+
+	Rows.Reset(Height);
+	Rows.AddZeroed(Height);
+}
+
+bool UInventoryGrid::PlaceItem(const FInventoryItemId ItemId)
+{
+	const FIntPoint Size = GetItemFootprint(ItemId);
+
+	FIntPoint Position;
+	if (FindBestFit(Size, Position))
+	{
+		AddPlacement(ItemId, Position, Size);
+		return true;
+	}
+
+	return bAutoArrange && Arrange(ItemId);
+}
+
+void UInventoryGrid::AddPlacement(const FInventoryItemId ItemId, const FIntPoint Position, const FIntPoint Size)
+{
+	PlacementIndices.Add(ItemId.Index, Placements.Num());
+
+	FInventoryGridPlacement& Placement = Placements.AddDefaulted_GetRef();
+	Placement.ItemId = ItemId;
+	Placement.Position = Position;
+	Placement.Size = Size;
+
+	SetCells(Position, Size, true);
+}
+
+void UInventoryGrid::RemovePlacement(const FInventoryItemId ItemId)
+{
+	int32 PlacementIndex;
+	if (!PlacementIndices.RemoveAndCopyValue(ItemId.Index, PlacementIndex))
+		return;
+
+	SetCells(Placements[PlacementIndex].Position, Placements[PlacementIndex].Size, false);
+
+	Placements.RemoveAtSwap(PlacementIndex, 1, false);
+	if (PlacementIndex < Placements.Num())
+		PlacementIndices[Placements[PlacementIndex].ItemId.Index] = PlacementIndex;
+}
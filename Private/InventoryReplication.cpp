@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryReplication.h"
+#include "Inventory.h"
+#include "InventorySystem.h"
+
+namespace
+{
+	// The quantities of an item type fit in [0, MaximumQuantity]. WriteInt
+	// and ReadInt need a value max of at least 2, even when the maximum
+	// quantity is 0.
+	uint32 GetQuantityValueMax(const UInventoryCatalog& Catalog, const FInventoryItemId ItemId)
+	{
+		return FMath::Max(uint32(Catalog.GetMaximumQuantity(ItemId)) + 1, 2u);
+	}
+}
+
+int64 FInventoryDeltaSerializer::WriteDelta(const UInventory& Inventory, const int64 AckedGeneration, FBitWriter& Writer)
+{
+	TArray<FInventoryItemId> ChangedItems;
+	const int64 Generation = Inventory.GetChangesSince(AckedGeneration, ChangedItems);
+
+	// Ascending ids so they delta encode into a few bits each
+	ChangedItems.Sort([](const FInventoryItemId A, const FInventoryItemId B) { return A.Index < B.Index; });
+
+	const UInventoryCatalog* Catalog = Inventory.Catalog;
+	uint64 Fingerprint = Catalog ? Catalog->GetFingerprint() : 0;
+	int64 DeltaGeneration = Generation;
+	uint32 NumChanged = ChangedItems.Num();
+
+	Writer << Fingerprint;
+	Writer << DeltaGeneration;
+	Writer.SerializeIntPacked(NumChanged);
+
+	int32 PreviousIndex = INDEX_NONE;
+	for (const FInventoryItemId ItemId : ChangedItems)
+	{
+		uint32 IndexDelta = ItemId.Index - PreviousIndex - 1;
+		Writer.SerializeIntPacked(IndexDelta);
+		PreviousIndex = ItemId.Index;
+
+		// AddItem accepts negative quantities, which are sent as 0
+		const int32 Quantity = FMath::Clamp(Inventory.Quantities[ItemId.Index], 0, Catalog->GetMaximumQuantity(ItemId));
+		Writer.WriteInt(uint32(Quantity), GetQuantityValueMax(*Catalog, ItemId));
+
+		if (Catalog->IsEquippable(ItemId))
+			Writer.WriteBit(Inventory.EquippedItems[ItemId.Index] ? 1 : 0);
+	}
+
+	return Generation;
+}
+
+bool FInventoryDeltaSerializer::ReadDelta(UInventory& Inventory, FBitReader& Reader, int64& InOutGeneration)
+{
+	const UInventoryCatalog* Catalog = Inventory.Catalog;
+
+	uint64 Fingerprint = 0;
+	int64 DeltaGeneration = 0;
+	uint32 NumChanged = 0;
+
+	Reader << Fingerprint;
+	Reader << DeltaGeneration;
+	Reader.SerializeIntPacked(NumChanged);
+
+	if (Reader.IsError())
+		return false;
+
+	if (Fingerprint != (Catalog ? Catalog->GetFingerprint() : 0))
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Cannot read inventory delta written against a different catalog"));
+		return false;
+	}
+
+	// Superseded by a delta that was already applied
+	if (DeltaGeneration <= InOutGeneration)
+		return true;
+
+	// Every tuple takes at least one bit
+	if (NumChanged > uint64(Reader.GetBitsLeft()))
+		return false;
+
+	struct FChangedItem
+	{
+		int32 Index;
+		int32 Quantity;
+		bool bEquipped;
+	};
+
+	TArray<FChangedItem, TInlineAllocator<16>> ChangedItems;
+	ChangedItems.Reserve(NumChanged);
+
+	// Validate everything before changing anything
+	int64 PreviousIndex = INDEX_NONE;
+	for (uint32 Changed = 0; Changed < NumChanged; ++Changed)
+	{
+		uint32 IndexDelta = 0;
+		Reader.SerializeIntPacked(IndexDelta);
+
+		const int64 Index = PreviousIndex + 1 + int64(IndexDelta);
+		const FInventoryItemId ItemId(int32(FMath::Min<int64>(Index, MAX_int32)));
+		if (Reader.IsError() || !Inventory.IsRegistered(ItemId))
+			return false;
+
+		const uint32 Quantity = Reader.ReadInt(GetQuantityValueMax(*Catalog, ItemId));
+		const bool bEquipped = Catalog->IsEquippable(ItemId) && Reader.ReadBit() != 0;
+		if (Reader.IsError() || Quantity > uint32(Catalog->GetMaximumQuantity(ItemId)))
+			return false;
+
+		ChangedItems.Add({ ItemId.Index, int32(Quantity), bEquipped });
+		PreviousIndex = Index;
+	}
+
+	for (const FChangedItem& ChangedItem : ChangedItems)
+	{
+		Inventory.SetQuantity(ChangedItem.Index, ChangedItem.Quantity);
+		Inventory.SetEquipped(ChangedItem.Index, ChangedItem.bEquipped);
+	}
+
+	InOutGeneration = DeltaGeneration;
+	return true;
+}
@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryService.h"
+#include "Misc/ScopeLock.h"
+#include "InventoryCatalog.h"
+
+namespace
+{
+	// Player ids are often sequential or share low bits, mix them so every
+	// bit decides the shard.
+	uint64 MixPlayerId(uint64 PlayerId)
+	{
+		PlayerId ^= PlayerId >> 33;
+		PlayerId *= 0xff51afd7ed558ccdull;
+		PlayerId ^= PlayerId >> 33;
+		PlayerId *= 0xc4ceb9fe1a85ec53ull;
+		PlayerId ^= PlayerId >> 33;
+		return PlayerId;
+	}
+}
+
+FInventoryService::FInventoryService(const UInventoryCatalog& InCatalog, int32 NumShards /* = 0 */)
+	: Catalog(InCatalog)
+{
+	if (NumShards <= 0)
+		NumShards = FPlatformMisc::NumberOfCoresIncludingHyperthreads() * 4;
+
+	const uint32 ShardCount = FMath::RoundUpToPowerOfTwo(uint32(NumShards));
+	Shards = MakeUnique<FShard[]>(ShardCount);
+	ShardMask = ShardCount - 1;
+}
+
+int32 FInventoryService::GetShardIndex(const uint64 PlayerId) const
+{
+	return int32(MixPlayerId(PlayerId) & ShardMask);
+}
+
+FInventoryService::FShard& FInventoryService::GetShard(const uint64 PlayerId) const
+{
+	return Shards[GetShardIndex(PlayerId)];
+}
+
+bool FInventoryService::RemovePlayer(const uint64 PlayerId)
+{
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	return Shard.Players.Remove(PlayerId) > 0;
+}
+
+InventoryError FInventoryService::AddItem(const uint64 PlayerId, const FInventoryItemId ItemId, const int32 Quantity /* = 1 */)
+{
+	return ApplyPlayerOp(PlayerId, InventoryOpType::EAdd, ItemId, Quantity);
+}
+
+InventoryError FInventoryService::ConsumeItem(const uint64 PlayerId, const FInventoryItemId ItemId, const int32 Quantity /* = 1 */)
+{
+	return ApplyPlayerOp(PlayerId, InventoryOpType::EConsume, ItemId, Quantity);
+}
+
+InventoryError FInventoryService::EquipItem(const uint64 PlayerId, const FInventoryItemId ItemId)
+{
+	return ApplyPlayerOp(PlayerId, InventoryOpType::EEquip, ItemId, 0);
+}
+
+InventoryError FInventoryService::UnequipItem(const uint64 PlayerId, const FInventoryItemId ItemId)
+{
+	return ApplyPlayerOp(PlayerId, InventoryOpType::EUnequip, ItemId, 0);
+}
+
+void FInventoryService::ApplyOps(const uint64 PlayerId, TConstArrayView<FInventoryOp> Ops, TArray<InventoryError>& OutResults)
+{
+	OutResults.Reset(Ops.Num());
+
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	FInventoryServicePlayer* Player = Shard.Players.Find(PlayerId);
+
+	for (const FInventoryOp& Op : Ops)
+	{
+		const FInventoryItemId ItemId = Op.ItemId.IsValid() ? Op.ItemId : Catalog.FindItemId(Op.Name);
+		const InventoryError Result = ValidateOp(Player, Op.Type, ItemId, Op.Quantity);
+		if (Result == InventoryError::ESuccess)
+		{
+			if (!Player)
+				Player = &Shard.Players.Add(PlayerId);
+
+			ExecuteOp(*Player, Op.Type, ItemId, Op.Quantity);
+		}
+
+		OutResults.Add(Result);
+	}
+}
+
+int32 FInventoryService::GetItemQuantity(const uint64 PlayerId, const FInventoryItemId ItemId) const
+{
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	const FInventoryServicePlayer* Player = Shard.Players.Find(PlayerId);
+	return Player ? Player->GetItemQuantity(ItemId) : 0;
+}
+
+bool FInventoryService::IsItemEquipped(const uint64 PlayerId, const FInventoryItemId ItemId) const
+{
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	const FInventoryServicePlayer* Player = Shard.Players.Find(PlayerId);
+	return Player && Player->IsItemEquipped(ItemId);
+}
+
+bool FInventoryService::ReadPlayer(const uint64 PlayerId, TFunctionRef<void(const FInventoryServicePlayer& Player)> Visitor) const
+{
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	const FInventoryServicePlayer* Player = Shard.Players.Find(PlayerId);
+	if (!Player)
+		return false;
+
+	Visitor(*Player);
+	return true;
+}
+
+int32 FInventoryService::NumPlayers() const
+{
+	int32 Num = 0;
+	for (uint32 Shard = 0; Shard <= ShardMask; ++Shard)
+	{
+		FScopeLock Lock(&Shards[Shard].Lock);
+		Num += Shards[Shard].Players.Num();
+	}
+	return Num;
+}
+
+InventoryError FInventoryService::ApplyPlayerOp(const uint64 PlayerId, const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity)
+{
+	FShard& Shard = GetShard(PlayerId);
+	FScopeLock Lock(&Shard.Lock);
+	FInventoryServicePlayer* Player = Shard.Players.Find(PlayerId);
+
+	// Players are only created by operations that succeed
+	const InventoryError Result = ValidateOp(Player, Type, ItemId, Quantity);
+	if (Result == InventoryError::ESuccess)
+		ExecuteOp(Player ? *Player : Shard.Players.Add(PlayerId), Type, ItemId, Quantity);
+
+	return Result;
+}
+
+InventoryError FInventoryService::ValidateOp(const FInventoryServicePlayer* Player, const InventoryOpType Type, 
+										const FInventoryItemId ItemId, const int32 Quantity) const
+{
+	if (!Catalog.IsValidItemId(ItemId))
+		return InventoryError::EInvalidItemType;
+
+	const int32 CurrentQuantity = Player ? Player->GetItemQuantity(ItemId) : 0;
+	const bool bEquipped = Player && Player->IsItemEquipped(ItemId);
+
+	switch (Type)
+	{
+	case InventoryOpType::EAdd:
+		if (CurrentQuantity + Quantity > Catalog.GetMaximumQuantity(ItemId))
+			return InventoryError::EMaxQuantityExceeded;
+
+		return InventoryError::ESuccess;
+
+	case InventoryOpType::EConsume:
+		if (!Catalog.IsConsumable(ItemId))
+			return InventoryError::ENotConsumable;
+
+		if (CurrentQuantity == 0)
+			return InventoryError::ENoItemsToConsume;
+
+		return InventoryError::ESuccess;
+
+	case InventoryOpType::EEquip:
+		if (!Catalog.IsEquippable(ItemId))
+			return InventoryError::ENotEquippable;
+
+		if (bEquipped)
+			return InventoryError::EAlreadyEquipped;
+
+		return InventoryError::ESuccess;
+
+	case InventoryOpType::EUnequip:
+		if (!Catalog.IsEquippable(ItemId))
+			return InventoryError::ENotEquippable;
+
+		if (!bEquipped)
+			return InventoryError::ENotEquipped;
+
+		return InventoryError::ESuccess;
+
+	default:
+		return InventoryError::EInvalidItemType;
+	}
+}
+
+void FInventoryService::ExecuteOp(FInventoryServicePlayer& Player, const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity) const
+{
+	if (Player.Quantities.Num() <= ItemId.Index)
+	{
+		const int32 NumToAdd = ItemId.Index + 1 - Player.Quantities.Num();
+		Player.Quantities.AddZeroed(NumToAdd);
+		Player.EquippedItems.Add(false, NumToAdd);
+	}
+
+	int32& CurrentQuantity = Player.Quantities[ItemId.Index];
+
+	switch (Type)
+	{
+	case InventoryOpType::EAdd:
+		CurrentQuantity += Quantity;
+		break;
+
+	case InventoryOpType::EConsume:
+		CurrentQuantity = FMath::Max(CurrentQuantity - Quantity, 0);
+		break;
+
+	case InventoryOpType::EEquip:
+		Player.EquippedItems[ItemId.Index] = true;
+		break;
+
+	case InventoryOpType::EUnequip:
+		Player.EquippedItems[ItemId.Index] = false;
+		break;
+	}
+}
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventorySnapshot.h"
+
+void FInventorySnapshotPublisher::Publish(FInventorySnapshotPtr Snapshot)
+{
+	const int32 OldSlot = CurrentSlot.load();
+	const int32 NewSlot = 1 - OldSlot;
+
+	// Readers only copy out of NewSlot after seeing it current, and every 
+	// reader of it finished before the previous publish returned.
+	Slots[NewSlot] = MoveTemp(Snapshot);
+	CurrentSlot.store(NewSlot);
+
+	// Readers announcing themselves on OldSlot from now on see it is no
+	// longer current and retry, so only readers already copying remain.
+	while (NumReaders[OldSlot].load() != 0)
+	{
+		FPlatformProcess::Yield();
+	}
+
+	Slots[OldSlot].Reset();
+}
+
+FInventorySnapshotPtr FInventorySnapshotPublisher::Acquire() const
+{
+	for (;;)
+	{
+		const int32 Slot = CurrentSlot.load();
+		NumReaders[Slot].fetch_add(1);
+
+		if (CurrentSlot.load() == Slot)
+		{
+			FInventorySnapshotPtr Snapshot = Slots[Slot];
+			NumReaders[Slot].fetch_sub(1);
+			return Snapshot;
+		}
+
+		NumReaders[Slot].fetch_sub(1);
+	}
+}
@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventorySort.h"
+#include "InventoryCatalog.h"
+
+namespace
+{
+	// The number of bits needed to hold values up to MaxValue
+	int32 BitsFor(const uint64 MaxValue)
+	{
+		return MaxValue == 0 ? 0 : 64 - FMath::CountLeadingZeros64(MaxValue);
+	}
+
+	enum class ESortFieldType : uint8
+	{
+		Category,
+		StatBoost,
+		NameRank,
+		Quantity,
+		ItemId
+	};
+
+	// A sort key mapped to [0, 2^NumBits) for every item
+	struct FSortField
+	{
+		ESortFieldType Type;
+		int32 NumBits;
+	};
+}
+
+void FInventoryRadixSort::Sort(TArray<FInventorySortEntry>& Entries, TArray<FInventorySortEntry>& Scratch, const int32 NumKeyBits /* = 64 */)
+{
+	const int32 Num = Entries.Num();
+	const int32 NumPasses = (FMath::Clamp(NumKeyBits, 0, 64) + 7) / 8;
+	if (Num < 2 || NumPasses == 0)
+		return;
+
+	uint32 Counts[8][256];
+	FMemory::Memzero(Counts, sizeof(Counts));
+
+	for (const FInventorySortEntry& Entry : Entries)
+	{
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			++Counts[Pass][(Entry.Key >> (Pass * 8)) & 0xff];
+		}
+	}
+
+	Scratch.SetNumUninitialized(Num, false);
+	FInventorySortEntry* Source = Entries.GetData();
+	FInventorySortEntry* Target = Scratch.GetData();
+
+	for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+	{
+		uint32* PassCounts = Counts[Pass];
+		const int32 Shift = Pass * 8;
+
+		// Every key has the same byte, this pass would not move anything
+		if (PassCounts[(Source[0].Key >> Shift) & 0xff] == uint32(Num))
+			continue;
+
+		uint32 Offset = 0;
+		for (int32 Digit = 0; Digit < 256; ++Digit)
+		{
+			const uint32 Count = PassCounts[Digit];
+			PassCounts[Digit] = Offset;
+			Offset += Count;
+		}
+
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Target[PassCounts[(Source[Index].Key >> Shift) & 0xff]++] = Source[Index];
+		}
+
+		Swap(Source, Target);
+	}
+
+	if (Source != Entries.GetData())
+		FMemory::Memcpy(Entries.GetData(), Source, Num * sizeof(FInventorySortEntry));
+}
+
+void FInventorySorter::Sort(const UInventoryCatalog& Catalog, TConstArrayView<int32> Quantities, const FInventorySortOrder& Order, 
+							TArray<FInventoryItemId>& InOutItemIds)
+{
+	const int32 NumItems = InOutItemIds.Num();
+	if (NumItems < 2)
+		return;
+
+	// The keys in order of significance
+	TArray<FSortField, TInlineAllocator<5>> Fields;
+
+	// The per item type keys are precomputed by the catalog and read 
+	// directly, the keys depending on the items being sorted are gathered
+	// once per item below
+	TConstArrayView<uint8> CategoryRanks;
+	TConstArrayView<int32> NameRanks;
+
+	if (Order.bByCategory)
+	{
+		CategoryRanks = Catalog.GetCategoryRanks();
+		Fields.Add({ ESortFieldType::Category, 2 });
+	}
+
+	// Stat boosts relative to the lowest or highest one, by position in InOutItemIds
+	TArray<uint64> BoostKeys;
+	const int32 StatId = Order.Stat.IsEmpty() ? INDEX_NONE : Catalog.FindStatId(Order.Stat);
+	if (StatId != INDEX_NONE)
+	{
+		TArray<int64> Boosts;
+		Boosts.Reserve(NumItems);
+
+		int64 MinBoost = MAX_int64;
+		int64 MaxBoost = MIN_int64;
+		for (const FInventoryItemId ItemId : InOutItemIds)
+		{
+			int64 Boost = 0;
+			for (const FInventoryStatModifier& Modifier : Catalog.GetModifiers(ItemId))
+			{
+				if (Modifier.StatId == StatId)
+				{
+					Boost = Modifier.Boost;
+					break;
+				}
+			}
+
+			Boosts.Add(Boost);
+			MinBoost = FMath::Min(MinBoost, Boost);
+			MaxBoost = FMath::Max(MaxBoost, Boost);
+		}
+
+		BoostKeys.SetNumUninitialized(NumItems);
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			BoostKeys[Index] = Order.bStatDescending ? uint64(MaxBoost - Boosts[Index]) : uint64(Boosts[Index] - MinBoost);
+		}
+
+		Fields.Add({ ESortFieldType::StatBoost, BitsFor(uint64(MaxBoost - MinBoost)) });
+	}
+
+	if (Order.bByName)
+	{
+		NameRanks = Catalog.GetNameRanks();
+		Fields.Add({ ESortFieldType::NameRank, BitsFor(Catalog.Num() - 1) });
+	}
+
+	// Quantities, reversed when descending, by position in InOutItemIds
+	TArray<uint32> QuantityKeys;
+	if (Order.bByQuantity)
+	{
+		QuantityKeys.SetNumUninitialized(NumItems);
+
+		uint32 MaxQuantity = 0;
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			const int32 ItemIndex = InOutItemIds[Index].Index;
+			QuantityKeys[Index] = Quantities.IsValidIndex(ItemIndex) ? uint32(FMath::Max(Quantities[ItemIndex], 0)) : 0;
+			MaxQuantity = FMath::Max(MaxQuantity, QuantityKeys[Index]);
+		}
+
+		if (Order.bQuantityDescending)
+		{
+			for (uint32& Key : QuantityKeys)
+			{
+				Key = MaxQuantity - Key;
+			}
+		}
+
+		Fields.Add({ ESortFieldType::Quantity, BitsFor(MaxQuantity) });
+	}
+
+	// Item id breaks the remaining ties
+	Fields.Add({ ESortFieldType::ItemId, BitsFor(Catalog.Num() - 1) });
+
+	// Entries refer to their position in the input, which indexes the
+	// gathered keys and the original item ids
+	const TArray<FInventoryItemId> ItemIds = InOutItemIds;
+
+	TArray<FInventorySortEntry> Entries;
+	TArray<FInventorySortEntry> Scratch;
+	Entries.SetNumUninitialized(NumItems);
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		Entries[Index].Value = Index;
+	}
+
+	// Pack the fields into words from the least significant field up and
+	// sort by each word in turn. Every pass is stable, so the last word
+	// sorted decides first and earlier words break its ties.
+	for (int32 LastField = Fields.Num() - 1; LastField >= 0;)
+	{
+		int32 FirstField = LastField;
+		int32 NumWordBits = Fields[LastField].NumBits;
+		while (FirstField > 0 && NumWordBits + Fields[FirstField - 1].NumBits <= 64)
+		{
+			NumWordBits += Fields[--FirstField].NumBits;
+		}
+
+		for (FInventorySortEntry& Entry : Entries)
+		{
+			const int32 Position = Entry.Value;
+			const int32 ItemIndex = ItemIds[Position].Index;
+
+			uint64 Key = 0;
+			for (int32 Field = FirstField; Field <= LastField; ++Field)
+			{
+				uint64 Value = 0;
+				switch (Fields[Field].Type)
+				{
+				case ESortFieldType::Category:	Value = CategoryRanks[ItemIndex]; break;
+				case ESortFieldType::StatBoost:	Value = BoostKeys[Position]; break;
+				case ESortFieldType::NameRank:	Value = uint64(NameRanks[ItemIndex]); break;
+				case ESortFieldType::Quantity:	Value = QuantityKeys[Position]; break;
+				case ESortFieldType::ItemId:	Value = uint64(ItemIndex); break;
+				}
+
+				Key = (Fields[Field].NumBits < 64 ? Key << Fields[Field].NumBits : 0) | Value;
+			}
+			Entry.Key = Key;
+		}
+
+		FInventoryRadixSort::Sort(Entries, Scratch, NumWordBits);
+		LastField = FirstField - 1;
+	}
+
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		InOutItemIds[Index] = ItemIds[Entries[Index].Value];
+	}
+}
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryTimingWheel.h"
+
+FInventoryTimingWheel::FInventoryTimingWheel()
+{
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		{
+			Slots[Level][Slot] = INDEX_NONE;
+		}
+	}
+}
+
+int32 FInventoryTimingWheel::Schedule(const FInventoryTimedBoost& Boost, const uint64 DueTick)
+{
+	int32 Handle;
+	if (FreeHead != INDEX_NONE)
+	{
+		Handle = FreeHead;
+		FreeHead = Timers[Handle].Next;
+	}
+	else
+	{
+		Handle = Timers.AddDefaulted();
+	}
+
+	Timers[Handle].Boost = Boost;
+	Reschedule(Handle, DueTick);
+	return Handle;
+}
+
+void FInventoryTimingWheel::Reschedule(const int32 Handle, const uint64 DueTick)
+{
+	Timers[Handle].DueTick = FMath::Max(DueTick, CurrentTick + 1);
+	Insert(Handle);
+	++NumScheduled;
+}
+
+void FInventoryTimingWheel::Release(const int32 Handle)
+{
+	Timers[Handle].Boost = FInventoryTimedBoost();
+	Timers[Handle].Next = FreeHead;
+	FreeHead = Handle;
+}
+
+void FInventoryTimingWheel::Insert(const int32 Handle)
+{
+	FTimer& Timer = Timers[Handle];
+
+	// Timers further out than the wheel spans park in the top level and are
+	// placed again each time their slot cascades.
+	const uint64 Delta = Timer.DueTick - CurrentTick;
+	const uint64 SlotTick = Delta > MaxDelta ? CurrentTick + MaxDelta : Timer.DueTick;
+
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+
+	const int32 Slot = (SlotTick >> (SlotBits * Level)) & (NumSlots - 1);
+	Timer.Next = Slots[Level][Slot];
+	Slots[Level][Slot] = Handle;
+}
+
+void FInventoryTimingWheel::Cascade(const int32 Level)
+{
+	const int32 Slot = (CurrentTick >> (SlotBits * Level)) & (NumSlots - 1);
+
+	int32 Handle = Slots[Level][Slot];
+	Slots[Level][Slot] = INDEX_NONE;
+
+	while (Handle != INDEX_NONE)
+	{
+		const int32 Next = Timers[Handle].Next;
+		Insert(Handle);
+		Handle = Next;
+	}
+}
+
+void FInventoryTimingWheel::Advance(const uint64 ToTick, TArray<int32>& OutFired)
+{
+	while (CurrentTick < ToTick)
+	{
+		++CurrentTick;
+
+		// Nothing to do for the ticks skipped while the wheel is empty
+		if (NumScheduled == 0)
+		{
+			CurrentTick = ToTick;
+			break;
+		}
+
+		if ((CurrentTick & (NumSlots - 1)) == 0)
+		{
+			// Cascade the highest level that wrapped first so its timers can
+			// land in the slots of the levels below that cascade next.
+			int32 Level = 1;
+			while (Level < NumLevels - 1 && ((CurrentTick >> (SlotBits * Level)) & (NumSlots - 1)) == 0)
+			{
+				++Level;
+			}
+
+			for (; Level >= 1; --Level)
+			{
+				Cascade(Level);
+			}
+		}
+
+		const int32 Slot = CurrentTick & (NumSlots - 1);
+		int32 Handle = Slots[0][Slot];
+		Slots[0][Slot] = INDEX_NONE;
+
+		while (Handle != INDEX_NONE)
+		{
+			const int32 Next = Timers[Handle].Next;
+			OutFired.Add(Handle);
+			--NumScheduled;
+			Handle = Next;
+		}
+	}
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryTransaction.h"
+#include "Inventory.h"
+
+FInventoryTransaction::FInventoryTransaction(UInventory& InInventory)
+	: Inventory(&InInventory)
+{
+}
+
+FInventoryTransaction::FJournalEntry* FInventoryTransaction::Touch(const FInventoryItemId ItemId)
+{
+	const UInventory* InventoryPtr = Inventory.Get();
+	if (!InventoryPtr || !InventoryPtr->IsRegistered(ItemId))
+		return nullptr;
+
+	for (FJournalEntry& Entry : Journal)
+	{
+		if (Entry.Index == ItemId.Index)
+			return &Entry;
+	}
+
+	FJournalEntry& Entry = Journal.AddDefaulted_GetRef();
+	Entry.Index = ItemId.Index;
+	Entry.bOriginalEquipped = InventoryPtr->EquippedItems[ItemId.Index];
+	Entry.bEquipped = Entry.bOriginalEquipped;
+	return &Entry;
+}
+
+InventoryError FInventoryTransaction::AddItem(const FInventoryItemId ItemId, const int32 Quantity /* = 1 */)
+{
+	FJournalEntry* Entry = Touch(ItemId);
+	if (!Entry)
+		return InventoryError::EInvalidItemType;
+
+	Entry->Added += Quantity;
+	return InventoryError::ESuccess;
+}
+
+InventoryError FInventoryTransaction::ConsumeItem(const FInventoryItemId ItemId, const int32 Quantity /* = 1 */)
+{
+	FJournalEntry* Entry = Touch(ItemId);
+	if (!Entry)
+		return InventoryError::EInvalidItemType;
+
+	Entry->Consumed += Quantity;
+	return InventoryError::ESuccess;
+}
+
+InventoryError FInventoryTransaction::EquipItem(const FInventoryItemId ItemId)
+{
+	FJournalEntry* Entry = Touch(ItemId);
+	if (!Entry)
+		return InventoryError::EInvalidItemType;
+
+	if (Entry->bEquipped)
+		return InventoryError::EAlreadyEquipped;
+
+	Entry->bEquipped = true;
+	return InventoryError::ESuccess;
+}
+
+InventoryError FInventoryTransaction::UnequipItem(const FInventoryItemId ItemId)
+{
+	FJournalEntry* Entry = Touch(ItemId);
+	if (!Entry)
+		return InventoryError::EInvalidItemType;
+
+	if (!Entry->bEquipped)
+		return InventoryError::ENotEquipped;
+
+	Entry->bEquipped = false;
+	return InventoryError::ESuccess;
+}
+
+InventoryError FInventoryTransaction::Commit(FInventoryItemId* OutFailedItem /* = nullptr */)
+{
+	UInventory* InventoryPtr = Inventory.Get();
+	if (!InventoryPtr)
+	{
+		Rollback();
+		return InventoryError::EInvalidItemType;
+	}
+
+	const UInventoryCatalog& Catalog = *InventoryPtr->Catalog;
+
+	auto Fail = [this, OutFailedItem](const FJournalEntry& Entry, const InventoryError Error)
+	{
+		if (OutFailedItem)
+			*OutFailedItem = FInventoryItemId(Entry.Index);
+
+		Rollback();
+		return Error;
+	};
+
+	// Validate every touched item once against its final state
+	for (const FJournalEntry& Entry : Journal)
+	{
+		const FInventoryItemId ItemId(Entry.Index);
+		const int32 FinalQuantity = InventoryPtr->Quantities[Entry.Index] + Entry.Added - Entry.Consumed;
+
+		if (Entry.Consumed > 0 && !Catalog.IsConsumable(ItemId))
+			return Fail(Entry, InventoryError::ENotConsumable);
+
+		if (FinalQuantity < 0)
+			return Fail(Entry, InventoryError::ENoItemsToConsume);
+
+		if (FinalQuantity > Catalog.GetMaximumQuantity(ItemId))
+			return Fail(Entry, InventoryError::EMaxQuantityExceeded);
+
+		if (Entry.bEquipped != Entry.bOriginalEquipped && !Catalog.IsEquippable(ItemId))
+			return Fail(Entry, InventoryError::ENotEquippable);
+
+		// The inventory changed since the item was staged
+		if (InventoryPtr->EquippedItems[Entry.Index] != Entry.bOriginalEquipped)
+			return Fail(Entry, Entry.bOriginalEquipped ? InventoryError::ENotEquipped : InventoryError::EAlreadyEquipped);
+	}
+
+	for (const FJournalEntry& Entry : Journal)
+	{
+		InventoryPtr->SetQuantity(Entry.Index, InventoryPtr->Quantities[Entry.Index] + Entry.Added - Entry.Consumed);
+		InventoryPtr->SetEquipped(Entry.Index, Entry.bEquipped);
+
+		if (Entry.Consumed > 0)
+			InventoryPtr->StartConsumedBoosts(Entry.Index, Entry.Consumed);
+	}
+
+	Journal.Reset();
+	return InventoryError::ESuccess;
+}
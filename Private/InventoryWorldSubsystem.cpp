@@ -0,0 +1,268 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryWorldSubsystem.h"
+#include "Inventory.h"
+
+bool UInventoryWorldSubsystem::StartTimedBoost(UInventory* Inventory, const FInventoryItemId ItemId, const FInventoryStatModifier& Modifier, const int32 Count)
+{
+	if (Modifier.Duration <= 0 && Modifier.Period <= 0)
+		return false;
+
+	const uint64 Now = TimingWheel.GetCurrentTick();
+	const uint64 SecondsToTicks = FMath::RoundToInt(1.0f / TickSeconds);
+
+	FInventoryTimedBoost Boost;
+	Boost.Inventory = Inventory;
+	Boost.ItemIndex = ItemId.Index;
+	Boost.StatId = Modifier.StatId;
+	Boost.Boost = Modifier.Boost * Count;
+	Boost.PeriodTicks = uint64(FMath::Max(Modifier.Period, 0)) * SecondsToTicks;
+	Boost.NextPulseTick = Now + Boost.PeriodTicks;
+	Boost.EndTick = Modifier.Duration > 0 ? Now + uint64(Modifier.Duration) * SecondsToTicks : MAX_uint64;
+
+	TimingWheel.Schedule(Boost, Boost.PeriodTicks > 0 ? FMath::Min(Boost.NextPulseTick, Boost.EndTick) : Boost.EndTick);
+	return true;
+}
+
+void UInventoryWorldSubsystem::RegisterInventory(UInventory* Inventory)
+{
+	if (Inventory->WorldIndex != INDEX_NONE)
+		return;
+
+	Inventory->WorldIndex = Inventories.Add(Inventory);
+
+	// Changes made before it started playing are flushed with this frame
+	MarkInventoryDirty(Inventory);
+}
+
+void UInventoryWorldSubsystem::MarkInventoryDirty(UInventory* Inventory)
+{
+	if (Inventory->DirtyIndex == INDEX_NONE)
+		Inventory->DirtyIndex = DirtyInventories.Add(Inventory);
+}
+
+void UInventoryWorldSubsystem::UnregisterInventory(UInventory* Inventory)
+{
+	const int32 Index = Inventory->WorldIndex;
+	if (!Inventories.IsValidIndex(Index) || Inventories[Index] != Inventory)
+		return;
+
+	const int32 DirtyIndex = Inventory->DirtyIndex;
+	Inventory->WorldIndex = INDEX_NONE;
+	Inventory->DirtyIndex = INDEX_NONE;
+
+	if (bUpdating)
+	{
+		Inventories[Index] = nullptr;
+		if (DirtyIndex != INDEX_NONE)
+			DirtyInventories[DirtyIndex] = nullptr;
+
+		bHasUnregisteredDuringUpdate = true;
+		return;
+	}
+
+	Inventories.RemoveAtSwap(Index, 1, false);
+	if (Inventories.IsValidIndex(Index))
+		Inventories[Index]->WorldIndex = Index;
+
+	if (DirtyIndex != INDEX_NONE)
+	{
+		DirtyInventories.RemoveAtSwap(DirtyIndex, 1, false);
+		if (DirtyInventories.IsValidIndex(DirtyIndex))
+			DirtyInventories[DirtyIndex]->DirtyIndex = DirtyIndex;
+	}
+}
+
+void UInventoryWorldSubsystem::CompactInventories()
+{
+	for (int32 Index = Inventories.Num() - 1; Index >= 0; --Index)
+	{
+		if (Inventories[Index])
+			continue;
+
+		Inventories.RemoveAtSwap(Index, 1, false);
+		if (Inventories.IsValidIndex(Index))
+			Inventories[Index]->WorldIndex = Index;
+	}
+
+	bHasUnregisteredDuringUpdate = false;
+}
+
+void UInventoryWorldSubsystem::ResetDirtyInventories()
+{
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < DirtyInventories.Num(); ++Index)
+	{
+		UInventory* Inventory = DirtyInventories[Index];
+		if (!Inventory)
+			continue;
+
+		// Changes made by listeners during the flush are broadcast next frame
+		if (Inventory->PendingChanges.Num() > 0)
+		{
+			Inventory->DirtyIndex = NumKept;
+			DirtyInventories[NumKept++] = Inventory;
+		}
+		else
+		{
+			Inventory->DirtyIndex = INDEX_NONE;
+		}
+	}
+
+	DirtyInventories.SetNum(NumKept, false);
+}
+
+void UInventoryWorldSubsystem::Tick(float DeltaTime)
+{
+	bUpdating = true;
+
+	ApplyQueuedOps();
+	AdvanceTimedBoosts(DeltaTime);
+	FlushChanges();
+	PublishSnapshots();
+
+	bUpdating = false;
+
+	ResetDirtyInventories();
+
+	if (bHasUnregisteredDuringUpdate)
+		CompactInventories();
+}
+
+ETickableTickType UInventoryWorldSubsystem::GetTickableTickType() const
+{
+	// The class default object is registered as a tickable too
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+TStatId UInventoryWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInventoryWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UInventoryWorldSubsystem::EnqueueOps(TWeakObjectPtr<UInventory> Inventory, TArray<FInventoryOp>&& Ops, FInventoryOpsCallback&& OnApplied /* = nullptr */)
+{
+	QueuedOps.Enqueue({ MoveTemp(Inventory), MoveTemp(Ops), MoveTemp(OnApplied) });
+	NumQueuedOps.Increment();
+}
+
+void UInventoryWorldSubsystem::ApplyQueuedOps()
+{
+	FQueuedOps Queued;
+	for (int32 NumToApply = NumQueuedOps.GetValue(); NumToApply > 0 && QueuedOps.Dequeue(Queued); --NumToApply)
+	{
+		NumQueuedOps.Decrement();
+
+		UInventory* Inventory = Queued.Inventory.Get();
+		if (Inventory)
+		{
+			Inventory->ApplyOps(Queued.Ops, QueuedOpResults);
+		}
+		else
+		{
+			QueuedOpResults.Init(InventoryError::EInvalidItemType, Queued.Ops.Num());
+		}
+
+		if (Queued.OnApplied)
+			Queued.OnApplied(QueuedOpResults);
+	}
+}
+
+void UInventoryWorldSubsystem::FlushChanges()
+{
+	// Listeners may change other inventories or start new ones playing,
+	// which are appended
+	for (int32 Index = 0; Index < DirtyInventories.Num(); ++Index)
+	{
+		if (UInventory* Inventory = DirtyInventories[Index])
+			Inventory->FlushChanges();
+	}
+}
+
+void UInventoryWorldSubsystem::PublishSnapshots()
+{
+	for (UInventory* Inventory : DirtyInventories)
+	{
+		if (Inventory)
+			Inventory->PublishSnapshot();
+	}
+}
+
+void UInventoryWorldSubsystem::AdvanceTimedBoosts(const float DeltaTime)
+{
+	ElapsedSeconds += DeltaTime;
+
+	FiredTimers.Reset();
+	TimingWheel.Advance(uint64(ElapsedSeconds / TickSeconds), FiredTimers);
+
+	if (FiredTimers.Num() == 0)
+		return;
+
+	FiredEvents.Reset();
+
+	for (const int32 Handle : FiredTimers)
+	{
+		FInventoryTimedBoost& Boost = TimingWheel.Get(Handle);
+		UInventory* Inventory = Boost.Inventory.Get();
+
+		if (!Inventory || Inventory->WorldIndex == INDEX_NONE)
+		{
+			// Non periodic timers only fire when they expire. Nobody is told
+			// about the expiry, but the boost must still end.
+			if (Inventory && Boost.PeriodTicks == 0)
+				Inventory->RemoveActiveBoost(Boost.StatId, Boost.Boost);
+
+			TimingWheel.Release(Handle);
+			continue;
+		}
+
+		const uint64 Now = TimingWheel.GetCurrentTick();
+
+		FInventoryBoostEvent Event;
+		Event.ItemId = FInventoryItemId(Boost.ItemIndex);
+		Event.StatId = Boost.StatId;
+		Event.Boost = Boost.Boost;
+		Event.bPeriodic = Boost.PeriodTicks > 0;
+
+		if (Boost.PeriodTicks > 0 && Now >= Boost.NextPulseTick)
+		{
+			Event.bExpired = false;
+			FiredEvents.Emplace(Inventory->WorldIndex, Event);
+			Boost.NextPulseTick += Boost.PeriodTicks;
+		}
+
+		if (Now >= Boost.EndTick)
+		{
+			Event.bExpired = true;
+			FiredEvents.Emplace(Inventory->WorldIndex, Event);
+			TimingWheel.Release(Handle);
+		}
+		else
+		{
+			TimingWheel.Reschedule(Handle, Boost.PeriodTicks > 0 ? FMath::Min(Boost.NextPulseTick, Boost.EndTick) : Boost.EndTick);
+		}
+	}
+
+	// Deliver one contiguous batch per inventory
+	FiredEvents.StableSort([](const TPair<int32, FInventoryBoostEvent>& A, const TPair<int32, FInventoryBoostEvent>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (int32 First = 0; First < FiredEvents.Num();)
+	{
+		const int32 WorldIndex = FiredEvents[First].Key;
+
+		InventoryEvents.Reset();
+		int32 Last = First;
+		for (; Last < FiredEvents.Num() && FiredEvents[Last].Key == WorldIndex; ++Last)
+		{
+			InventoryEvents.Add(FiredEvents[Last].Value);
+		}
+
+		if (UInventory* Inventory = Inventories[WorldIndex])
+			Inventory->HandleBoostEvents(InventoryEvents);
+		First = Last;
+	}
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 30;
+
+	InventoryError ApplySingleOp(UInventory& Inventory, const FInventoryOp& Op)
+	{
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:		return Inventory.AddItem(Op.Name, Op.Quantity);
+		case InventoryOpType::EConsume:	return Inventory.ConsumeItem(Op.Name, Op.Quantity);
+		case InventoryOpType::EEquip:	return Inventory.EquipItem(Op.Name);
+		case InventoryOpType::EUnequip:	return Inventory.UnequipItem(Op.Name);
+		}
+		return InventoryError::EInvalidItemType;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryBatchOpsTest, "InventorySystem.Batch.ApplyOps",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryBatchOpsTest::RunTest(const FString& Parameters)
+{
+	UInventory* Batched = InventoryTests::MakeInventory(NumItemTypes);
+	UInventory* Single = InventoryTests::MakeInventory(NumItemTypes, Batched->GetCatalog());
+
+	// Batches mixing handles, names and unknown names give the result every
+	// operation would get on its own, later operations seeing earlier ones
+	FRandomStream Random(11);
+	for (int32 Round = 0; Round < 50; ++Round)
+	{
+		TArray<FInventoryOp> Ops;
+		for (int32 Step = 0; Step < 40; ++Step)
+		{
+			FInventoryOp& Op = Ops.Add_GetRef(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+			Op.Name = InventoryTests::GetItemName(Op.ItemId.Index);
+			if (Step % 3 == 0)
+				Op.ItemId = FInventoryItemId();
+			if (Step % 17 == 0)
+				Op.Name = TEXT("NotAnItem");
+		}
+
+		const TArray<InventoryError> Results = Batched->ApplyOps(Ops);
+		if (!TestEqual(TEXT("Number of results"), Results.Num(), Ops.Num()))
+			return false;
+
+		for (int32 Index = 0; Index < Ops.Num(); ++Index)
+		{
+			FInventoryOp Op = Ops[Index];
+			if (Op.ItemId.IsValid())
+				Op.Name = InventoryTests::GetItemName(Op.ItemId.Index);
+
+			if (!TestEqual(TEXT("Result of op"), (int32)Results[Index], (int32)ApplySingleOp(*Single, Op)))
+				return false;
+		}
+
+		if (!TestTrue(TEXT("Batched state"), InventoryTests::HaveSameState(*Batched, *Single, NumItemTypes)))
+			return false;
+	}
+
+	// Stacks of the same item type add up in order until the maximum
+	const FString Name = InventoryTests::GetItemName(1);
+	const int32 MaximumQuantity = Batched->GetCatalog()->GetMaximumQuantity(FInventoryItemId(1));
+	Batched->ConsumeItem(Name, MaximumQuantity);
+
+	FInventoryItemStack Stack;
+	Stack.Name = Name;
+	Stack.Quantity = MaximumQuantity - 1;
+	FInventoryItemStack Unknown;
+	Unknown.Name = TEXT("NotAnItem");
+	const TArray<InventoryError> AddResults = Batched->AddItems({ Stack, Unknown, Stack });
+	TestTrue(TEXT("Add results"), AddResults == TArray<InventoryError>({ InventoryError::ESuccess, InventoryError::EInvalidItemType,
+		InventoryError::EMaxQuantityExceeded }));
+	TestEqual(TEXT("Quantity after adding stacks"), Batched->GetItemQuantity(FInventoryItemId(1)), MaximumQuantity - 1);
+
+	Stack.Quantity = 1;
+	const TArray<InventoryError> ConsumeResults = Batched->ConsumeItems({ Stack, Stack });
+	TestTrue(TEXT("Consume results"), ConsumeResults == TArray<InventoryError>({ InventoryError::ESuccess, InventoryError::ESuccess }));
+	TestEqual(TEXT("Quantity after consuming stacks"), Batched->GetItemQuantity(FInventoryItemId(1)), MaximumQuantity - 3);
+
+	// An empty batch changes nothing
+	const int64 Generation = Batched->GetGeneration();
+	TestEqual(TEXT("Results of an empty batch"), Batched->ApplyOps(TArray<FInventoryOp>()).Num(), 0);
+	TestEqual(TEXT("Generation after an empty batch"), Batched->GetGeneration(), Generation);
+
+	return true;
+}
+
+#endif
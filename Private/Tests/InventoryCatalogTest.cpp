@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Algo/Compare.h"
+#include "Engine/DataTable.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 10;
+
+	// Owns one of every item type it can hold, so searches see every name
+	void AddEveryItem(UInventory& Inventory, const int32 NumItems)
+	{
+		for (int32 I = 0; I < NumItems; ++I)
+		{
+			Inventory.AddItem(FInventoryItemId(I), 1);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryCatalogBulkRegistrationTest, "InventorySystem.Catalog.BulkRegistration",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryCatalogBulkRegistrationTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(0);
+	UInventoryCatalog* Catalog = Inventory->GetCatalog();
+
+	TArray<FInventoryItemDefinition> Definitions;
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		Definitions.Add(InventoryTests::MakeItemDefinition(I));
+	}
+
+	// An identical repeat, a different definition under a taken name and a
+	// definition using a stat the inventory does not have
+	Definitions.Add(InventoryTests::MakeItemDefinition(3));
+	Definitions.Add_GetRef(InventoryTests::MakeItemDefinition(4)).MaximumQuantity += 1;
+	FInventoryItemDefinition& Lucky = Definitions.AddDefaulted_GetRef();
+	Lucky.Name = TEXT("Lucky");
+	Lucky.StatsBoostsAndDurations.Add(TEXT("Luck"));
+
+	TArray<FInventoryItemId> ItemIds;
+	TArray<InventoryError> Results;
+	TestEqual(TEXT("First error of the batch"), (int32)Inventory->AddInventoryItemTypes(MoveTemp(Definitions), ItemIds, Results),
+		(int32)InventoryError::EDuplicateItemType);
+	TestEqual(TEXT("Definitions are moved from"), Definitions.Num(), 0);
+	if (!TestEqual(TEXT("Results"), Results.Num(), NumItemTypes + 3) || !TestEqual(TEXT("Item ids"), ItemIds.Num(), NumItemTypes + 3))
+		return false;
+
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		TestEqual(TEXT("Added item type"), (int32)Results[I], (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Added item id"), ItemIds[I].Index, I);
+		TestTrue(TEXT("Added item type is registered"), Inventory->IsRegistered(ItemIds[I]));
+	}
+
+	TestEqual(TEXT("Identical repeat"), (int32)Results[NumItemTypes], (int32)InventoryError::EDuplicateItemType);
+	TestEqual(TEXT("Identical repeat id"), ItemIds[NumItemTypes].Index, 3);
+	TestEqual(TEXT("Different definition"), (int32)Results[NumItemTypes + 1], (int32)InventoryError::EDuplicateItemType);
+	TestEqual(TEXT("Different definition id"), ItemIds[NumItemTypes + 1].Index, 4);
+	TestEqual(TEXT("Unknown stat"), (int32)Results[NumItemTypes + 2], (int32)InventoryError::EInvalidStatUsed);
+	TestFalse(TEXT("Unknown stat id"), ItemIds[NumItemTypes + 2].IsValid());
+	TestEqual(TEXT("Item types in the catalog"), Catalog->Num(), NumItemTypes);
+	TestEqual(TEXT("Maximum quantity of the first definition wins"), Catalog->GetMaximumQuantity(FInventoryItemId(4)),
+		InventoryTests::MakeItemDefinition(4).MaximumQuantity);
+
+	// Adding again, one by one or in bulk, reports the registered item types
+	const FInventoryItemDefinition Again = InventoryTests::MakeItemDefinition(1);
+	FInventoryItemId AgainId;
+	TestEqual(TEXT("Single add of a registered item type"), (int32)Inventory->AddInventoryItemType(AgainId, Again.Name, Again.FlavorText,
+		nullptr, nullptr, Again.StatsBoostsAndDurations, Again.MaximumQuantity, Again.IsConsumable, Again.IsEquippable),
+		(int32)InventoryError::EDuplicateItemType);
+	TestEqual(TEXT("Single add of a registered item type id"), AgainId.Index, 1);
+
+	TestEqual(TEXT("Bulk add of a registered item type"), (int32)Inventory->AddInventoryItemTypes({ Again }, ItemIds, Results),
+		(int32)InventoryError::EDuplicateItemType);
+	TestEqual(TEXT("Bulk add of a registered item type id"), ItemIds[0].Index, 1);
+
+	// A second inventory sharing the catalog reuses identical item types and
+	// only rejects the different ones
+	UInventory* Other = InventoryTests::MakeInventory(0, Catalog);
+	TArray<FInventoryItemDefinition> OtherDefinitions;
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		OtherDefinitions.Add(InventoryTests::MakeItemDefinition(I));
+	}
+	OtherDefinitions[5].FlavorText = TEXT("Different");
+
+	Other->AddInventoryItemTypes(MoveTemp(OtherDefinitions), ItemIds, Results);
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		TestEqual(TEXT("Shared item id"), ItemIds[I].Index, I);
+		TestEqual(TEXT("Shared item type"), (int32)Results[I], (int32)(I == 5 ? InventoryError::EDuplicateItemType : InventoryError::ESuccess));
+		TestEqual(TEXT("Shared item type is registered"), Other->IsRegistered(FInventoryItemId(I)), I != 5);
+	}
+	TestEqual(TEXT("Item types in the shared catalog"), Catalog->Num(), NumItemTypes);
+
+	// DataTable rows go through the same path, rows without a name use
+	// their row name
+	UDataTable* Table = NewObject<UDataTable>();
+	Table->RowStruct = FInventoryItemDefinition::StaticStruct();
+	FInventoryItemDefinition Row = InventoryTests::MakeItemDefinition(NumItemTypes);
+	Row.Name.Empty();
+	Table->AddRow(FName(TEXT("RowName")), Row);
+	Table->AddRow(FName(TEXT("Repeat")), InventoryTests::MakeItemDefinition(0));
+
+	TestEqual(TEXT("DataTable rows"), (int32)Inventory->AddInventoryItemTypesFromDataTable(Table), (int32)InventoryError::EDuplicateItemType);
+	TestTrue(TEXT("Row named after its row"), Inventory->IsRegistered(Inventory->FindItemId(TEXT("RowName"))));
+	TestEqual(TEXT("Item types after the DataTable"), Catalog->Num(), NumItemTypes + 1);
+	TestEqual(TEXT("Table without item rows"), (int32)Inventory->AddInventoryItemTypesFromDataTable(NewObject<UDataTable>()),
+		(int32)InventoryError::EInvalidItemType);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryCatalogCookedRoundTripTest, "InventorySystem.Catalog.CookedRoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryCatalogCookedRoundTripTest::RunTest(const FString& Parameters)
+{
+	UInventory* Source = InventoryTests::MakeInventory(NumItemTypes);
+	UInventoryCatalog* SourceCatalog = Source->GetCatalog();
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("InventoryCatalogTest.icat"));
+	if (!TestTrue(TEXT("Save cooked catalog"), SourceCatalog->SaveCookedCatalog(Filename)))
+		return false;
+
+	for (const bool bVerifyContents : { false, true })
+	{
+		UInventoryCatalog* Loaded = NewObject<UInventoryCatalog>();
+		if (!TestTrue(TEXT("Load cooked catalog"), Loaded->LoadCookedCatalog(Filename, bVerifyContents)))
+			return false;
+
+		// Every item type and stat reads back as it was saved
+		TestEqual(TEXT("Loaded item types"), Loaded->Num(), SourceCatalog->Num());
+		TestEqual(TEXT("Loaded stats"), Loaded->NumStats(), SourceCatalog->NumStats());
+		TestEqual(TEXT("Loaded fingerprint"), int64(Loaded->GetFingerprint()), int64(SourceCatalog->GetFingerprint()));
+		for (int32 StatId = 0; StatId < SourceCatalog->NumStats(); ++StatId)
+		{
+			TestEqual(TEXT("Loaded stat name"), FString(Loaded->GetStatName(StatId)), FString(SourceCatalog->GetStatName(StatId)));
+		}
+		for (int32 I = 0; I < NumItemTypes; ++I)
+		{
+			const FInventoryItemId ItemId(I);
+			TestEqual(TEXT("Loaded name"), FString(Loaded->GetName(ItemId)), FString(SourceCatalog->GetName(ItemId)));
+			TestEqual(TEXT("Loaded flavor text"), FString(Loaded->GetFlavorText(ItemId)), FString(SourceCatalog->GetFlavorText(ItemId)));
+			TestEqual(TEXT("Loaded maximum quantity"), Loaded->GetMaximumQuantity(ItemId), SourceCatalog->GetMaximumQuantity(ItemId));
+			TestEqual(TEXT("Loaded consumable"), Loaded->IsConsumable(ItemId), SourceCatalog->IsConsumable(ItemId));
+			TestEqual(TEXT("Loaded equippable"), Loaded->IsEquippable(ItemId), SourceCatalog->IsEquippable(ItemId));
+			TestTrue(TEXT("Loaded modifiers"), Algo::Compare(Loaded->GetModifiers(ItemId), SourceCatalog->GetModifiers(ItemId)));
+			TestEqual(TEXT("Loaded name lookup"), Loaded->FindItemId(InventoryTests::GetItemName(I)).Index, I);
+		}
+
+		// Inventories use the loaded catalog like the one it was saved from,
+		// item types added at runtime follow the cooked ones
+		UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes + 1, Loaded);
+		TestTrue(TEXT("Inventory uses the loaded catalog"), Inventory->GetCatalog() == Loaded);
+		TestEqual(TEXT("Runtime item type follows the cooked ones"), Inventory->FindItemId(InventoryTests::GetItemName(NumItemTypes)).Index,
+			NumItemTypes);
+		TestEqual(TEXT("Item types after a runtime add"), Loaded->Num(), NumItemTypes + 1);
+		TestNotEqual(TEXT("Fingerprint after a runtime add"), int64(Loaded->GetFingerprint()), int64(SourceCatalog->GetFingerprint()));
+
+		UInventory* Reference = InventoryTests::MakeInventory(NumItemTypes + 1);
+		AddEveryItem(*Inventory, NumItemTypes + 1);
+		AddEveryItem(*Reference, NumItemTypes + 1);
+		for (const TCHAR* Query : { TEXT("item00"), TEXT("M01"), TEXT("0"), TEXT("") })
+		{
+			for (const bool bPrefix : { false, true })
+			{
+				TestTrue(FString::Printf(TEXT("Search for '%s' after a load"), Query),
+					Inventory->SearchItems(Query, bPrefix) == Reference->SearchItems(Query, bPrefix));
+			}
+		}
+
+		TestFalse(TEXT("Load into a catalog with item types"), Loaded->LoadCookedCatalog(Filename, bVerifyContents));
+	}
+
+	// Truncated files fail the section bounds checks, changed contents fail
+	// the fingerprint when verified
+	TArray<uint8> Cooked;
+	if (!TestTrue(TEXT("Read cooked catalog"), FFileHelper::LoadFileToArray(Cooked, *Filename)))
+		return false;
+
+	const FString BrokenFilename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("InventoryCatalogTestBroken.icat"));
+	FFileHelper::SaveArrayToFile(TArrayView<const uint8>(Cooked.GetData(), Cooked.Num() / 2), *BrokenFilename);
+	TestFalse(TEXT("Load of a truncated file"), NewObject<UInventoryCatalog>()->LoadCookedCatalog(BrokenFilename));
+
+	Cooked.Last() ^= 0x5A;
+	FFileHelper::SaveArrayToFile(Cooked, *BrokenFilename);
+	TestFalse(TEXT("Verified load of a changed file"), NewObject<UInventoryCatalog>()->LoadCookedCatalog(BrokenFilename, true));
+	TestFalse(TEXT("Load of a missing file"), NewObject<UInventoryCatalog>()->LoadCookedCatalog(BrokenFilename + TEXT(".missing")));
+
+	IFileManager::Get().Delete(*Filename);
+	IFileManager::Get().Delete(*BrokenFilename);
+
+	return true;
+}
+
+#endif
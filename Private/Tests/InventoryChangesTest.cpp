@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Algo/Sort.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 40;
+
+	InventoryError ApplyOp(UInventory& Inventory, const FInventoryOp& Op)
+	{
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:		return Inventory.AddItem(Op.ItemId, Op.Quantity);
+		case InventoryOpType::EConsume:	return Inventory.ConsumeItem(Op.ItemId, Op.Quantity);
+		case InventoryOpType::EEquip:	return Inventory.EquipItem(Op.ItemId);
+		case InventoryOpType::EUnequip:	return Inventory.UnequipItem(Op.ItemId);
+		}
+		return InventoryError::EInvalidItemType;
+	}
+
+	bool IsChange(const FInventoryItemChange& Change, const int32 Index, const int32 OldQuantity, const int32 NewQuantity,
+		const bool bOldEquipped, const bool bNewEquipped)
+	{
+		return Change.ItemId.Index == Index && Change.OldQuantity == OldQuantity && Change.NewQuantity == NewQuantity
+			&& Change.bOldEquipped == bOldEquipped && Change.bNewEquipped == bNewEquipped;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryChangesSinceTest, "InventorySystem.Changes.GenerationsAndDeltas",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryChangesSinceTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	TestEqual(TEXT("Generation before any change"), Inventory->GetGeneration(), int64(0));
+
+	TArray<FInventoryItemId> Changed;
+	TestEqual(TEXT("Changes of a new inventory"), Inventory->GetChangesSince(0, Changed), int64(0));
+	TestEqual(TEXT("Changed items of a new inventory"), Changed.Num(), 0);
+
+	// Generations at which the consumer polled
+	TArray<int64> Polls = { 0 };
+
+	FRandomStream Random(7);
+	for (int32 Step = 0; Step < 2000; ++Step)
+	{
+		const FInventoryOp Op = InventoryTests::MakeRandomOp(Random, NumItemTypes);
+		const int64 OldGeneration = Inventory->GetGeneration();
+		const int32 OldQuantity = Inventory->GetItemQuantity(Op.ItemId);
+		const bool bOldEquipped = Inventory->IsItemEquipped(Op.ItemId);
+
+		ApplyOp(*Inventory, Op);
+
+		// Only a real change moves the generation, and stamps the item with it
+		const bool bChanged = Inventory->GetItemQuantity(Op.ItemId) != OldQuantity || Inventory->IsItemEquipped(Op.ItemId) != bOldEquipped;
+		if (bChanged)
+		{
+			TestTrue(TEXT("Generation increases on a change"), Inventory->GetGeneration() > OldGeneration);
+			TestEqual(TEXT("Item generation"), Inventory->GetItemGeneration(Op.ItemId), Inventory->GetGeneration());
+		}
+		else
+		{
+			TestEqual(TEXT("Generation without a change"), Inventory->GetGeneration(), OldGeneration);
+		}
+
+		if (Step % 37 == 0)
+			Polls.Add(Inventory->GetGeneration());
+	}
+
+	// Every poll gets each item changed after it once, most recent first
+	for (const int64 Since : Polls)
+	{
+		TArray<FInventoryItemId> Expected;
+		for (int32 Index = 0; Index < NumItemTypes; ++Index)
+		{
+			if (Inventory->GetItemGeneration(FInventoryItemId(Index)) > Since)
+				Expected.Add(FInventoryItemId(Index));
+		}
+		Algo::Sort(Expected, [Inventory](const FInventoryItemId A, const FInventoryItemId B)
+		{
+			return Inventory->GetItemGeneration(A) > Inventory->GetItemGeneration(B);
+		});
+
+		TestEqual(TEXT("Changes return the current generation"), Inventory->GetChangesSince(Since, Changed), Inventory->GetGeneration());
+		if (!TestTrue(FString::Printf(TEXT("Changes since generation %lld"), Since), Changed == Expected))
+			return false;
+	}
+
+	TestEqual(TEXT("Changes since the current generation"), Inventory->GetChangesSince(Inventory->GetGeneration(), Changed), Inventory->GetGeneration());
+	TestEqual(TEXT("Changed items since the current generation"), Changed.Num(), 0);
+	TestEqual(TEXT("Generation of an unknown item"), Inventory->GetItemGeneration(FInventoryItemId(NumItemTypes)), int64(0));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryChangesCoalescedTest, "InventorySystem.Changes.Coalesced",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryChangesCoalescedTest::RunTest(const FString& Parameters)
+{
+	InventoryTests::FTestWorld TestWorld;
+	UInventoryWorldSubsystem* Subsystem = TestWorld.GetSubsystem();
+	if (!TestNotNull(TEXT("World subsystem"), Subsystem))
+		return false;
+
+	// Test item types with the properties the cases need, see
+	// InventoryTests::MakeItemDefinition
+	const FInventoryItemId Sword(0);		// Maximum 1, equippable, not consumable
+	const FInventoryItemId Potion(1);		// Maximum 4, consumable, not equippable
+	const FInventoryItemId Ring(2);			// Maximum 7, consumable and equippable
+	const FInventoryItemId Stone(3);		// Maximum 10, neither
+
+	UInventory* Inventory = TestWorld.SpawnInventory();
+	InventoryTests::AddTestItemTypes(*Inventory, 4);
+
+	TArray<FInventoryItemChange> Received;
+	TMap<int32, FDelegateHandle> Handles;
+	for (const FInventoryItemId ItemId : { Potion, Ring, Stone })
+	{
+		Handles.Add(ItemId.Index, Inventory->SubscribeToItem(ItemId, FOnInventoryItemChanged::FDelegate::CreateLambda(
+			[&Received](const FInventoryItemChange& Change)
+			{
+				Received.Add(Change);
+			})));
+	}
+
+	// Every change of a frame reaches the subscribers once, at the end of
+	// the frame, from the state at its start to the state at its end
+	Inventory->AddItem(Potion, 2);
+	Inventory->AddItem(Potion, 1);
+	Inventory->ConsumeItem(Potion, 1);
+	Inventory->AddItem(Ring, 3);
+	Inventory->EquipItem(Ring);
+	TestEqual(TEXT("Nothing received during the frame"), Received.Num(), 0);
+
+	Subsystem->Tick(0.1f);
+	if (!TestEqual(TEXT("One change per item"), Received.Num(), 2))
+		return false;
+	TestTrue(TEXT("Coalesced quantity change"), IsChange(Received[0], Potion.Index, 0, 2, false, false));
+	TestTrue(TEXT("Coalesced quantity and equip change"), IsChange(Received[1], Ring.Index, 0, 3, false, true));
+
+	// Items that changed back within a frame are left out
+	Received.Reset();
+	Inventory->AddItem(Potion, 2);
+	Inventory->ConsumeItem(Potion, 2);
+	Inventory->UnequipItem(Ring);
+	Inventory->EquipItem(Ring);
+	Subsystem->Tick(0.1f);
+	TestEqual(TEXT("Changes back are left out"), Received.Num(), 0);
+
+	// Only subscribed items are delivered, changes made by a subscriber
+	// are delivered the frame after
+	bool bSwordChanged = false;
+	const FDelegateHandle SwordHandle = Inventory->SubscribeToItem(Sword, FOnInventoryItemChanged::FDelegate::CreateLambda(
+		[&bSwordChanged, Inventory, Stone](const FInventoryItemChange& Change)
+		{
+			bSwordChanged = true;
+			Inventory->AddItem(Stone, 1);
+		}));
+	Inventory->AddItem(Stone, 5);
+	Inventory->AddItem(Sword, 1);
+	Subsystem->Tick(0.1f);
+	TestTrue(TEXT("Subscriber of the other item notified"), bSwordChanged);
+	if (!TestEqual(TEXT("Changes of a frame with a subscriber changing items"), Received.Num(), 1))
+		return false;
+	TestTrue(TEXT("Change made during the frame"), IsChange(Received[0], Stone.Index, 0, 5, false, false));
+
+	Received.Reset();
+	Inventory->UnsubscribeFromItem(Sword, SwordHandle);
+	Subsystem->Tick(0.1f);
+	if (!TestEqual(TEXT("Changes of the frame after a subscriber changed items"), Received.Num(), 1))
+		return false;
+	TestTrue(TEXT("Change made by a subscriber"), IsChange(Received[0], Stone.Index, 5, 6, false, false));
+
+	// Unsubscribed items are not delivered any more
+	Received.Reset();
+	Inventory->UnsubscribeFromItem(Stone, Handles[Stone.Index]);
+	Inventory->AddItem(Stone, 1);
+	Inventory->EquipItem(Sword);
+	Subsystem->Tick(0.1f);
+	TestEqual(TEXT("Changes after unsubscribing"), Received.Num(), 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 60;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryEquippedIndexTest, "InventorySystem.Equipped.Index",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryEquippedIndexTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	TestEqual(TEXT("Nothing equipped at first"), Inventory->GetEquippedItemIds().Num(), 0);
+
+	FRandomStream Random(5);
+	TArray<FInventoryItem> EquippedItems;
+	for (int32 Step = 0; Step < 3000; ++Step)
+	{
+		const FInventoryOp Op = InventoryTests::MakeRandomOp(Random, NumItemTypes);
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:		Inventory->AddItem(Op.ItemId, Op.Quantity); break;
+		case InventoryOpType::EConsume:	Inventory->ConsumeItem(Op.ItemId, Op.Quantity); break;
+		case InventoryOpType::EEquip:	Inventory->EquipItem(Op.ItemId); break;
+		case InventoryOpType::EUnequip:	Inventory->UnequipItem(Op.ItemId); break;
+		}
+
+		// The equipped set holds exactly the equipped items, each once
+		TArray<FInventoryItemId> Expected;
+		for (int32 Index = 0; Index < NumItemTypes; ++Index)
+		{
+			if (Inventory->IsItemEquipped(FInventoryItemId(Index)))
+				Expected.Add(FInventoryItemId(Index));
+		}
+
+		TArray<FInventoryItemId> Equipped(Inventory->GetEquippedItemIds());
+		Equipped.Sort([](const FInventoryItemId A, const FInventoryItemId B) { return A.Index < B.Index; });
+		if (!TestTrue(TEXT("Equipped set"), Equipped == Expected))
+			return false;
+
+		TestEqual(TEXT("Equipped bits"), Inventory->GetEquippedItemBits().CountSetBits(), Expected.Num());
+
+		Inventory->GetEquippedItemsInto(EquippedItems);
+		if (!TestEqual(TEXT("Equipped items"), EquippedItems.Num(), Expected.Num()))
+			return false;
+
+		for (const FInventoryItem& Item : EquippedItems)
+		{
+			TestTrue(TEXT("Equipped item"), Item.IsEquipped && Expected.Contains(Inventory->FindItemId(Item.Name)));
+		}
+	}
+
+	TestTrue(TEXT("Something was equipped"), Inventory->GetEquippedItemIds().Num() > 0);
+	TestEqual(TEXT("Equipped items by copy"), Inventory->GetEquippedItems().Num(), Inventory->GetEquippedItemIds().Num());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryEquippedStatTotalsTest, "InventorySystem.Equipped.StatTotals",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryEquippedStatTotalsTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+
+	FRandomStream Random(8);
+	TArray<FInventoryOp> Ops;
+	for (int32 Round = 0; Round < 100; ++Round)
+	{
+		Ops.Reset();
+		for (int32 Step = 0; Step < 20; ++Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+		Inventory->ApplyOps(Ops);
+
+		// The boosts of every equipped item, whatever its quantity
+		for (const TCHAR* StatName : InventoryTests::StatNames)
+		{
+			int32 Expected = 0;
+			for (int32 I = 0; I < NumItemTypes; ++I)
+			{
+				const FBoostAndDuration* Boost = InventoryTests::MakeItemDefinition(I).StatsBoostsAndDurations.Find(StatName);
+				if (Boost && Inventory->IsItemEquipped(FInventoryItemId(I)))
+					Expected += Boost->Boost;
+			}
+
+			if (!TestEqual(FString::Printf(TEXT("Total of %s"), StatName), Inventory->GetEquippedStatTotal(StatName), Expected))
+				return false;
+		}
+
+		if (!TestTrue(TEXT("Incremental totals match a recompute"), Inventory->ValidateEquippedStatTotals()))
+			return false;
+	}
+
+	TestEqual(TEXT("Total of an unknown stat"), Inventory->GetEquippedStatTotal(TEXT("NotAStat")), 0);
+	TestEqual(TEXT("Total of an unknown stat id"), Inventory->GetEquippedStatTotal(1000), 0);
+
+	// Unequipping everything brings every total back to 0
+	for (const FInventoryItemId ItemId : TArray<FInventoryItemId>(Inventory->GetEquippedItemIds()))
+	{
+		Inventory->UnequipItem(ItemId);
+	}
+	for (const int32 Total : Inventory->GetEquippedStatTotals())
+	{
+		TestEqual(TEXT("Total with nothing equipped"), Total, 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryGrid.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 8;
+
+	// Adds a grid of the given size to the actor of an inventory spawned in
+	// the test world, after registering the test item types
+	UInventoryGrid* SpawnGrid(InventoryTests::FTestWorld& TestWorld, const int32 Width, const int32 Height)
+	{
+		UInventory* Inventory = TestWorld.SpawnInventory();
+		InventoryTests::AddTestItemTypes(*Inventory, NumItemTypes);
+
+		UInventoryGrid* Grid = NewObject<UInventoryGrid>(TestWorld.Actors.Last());
+		Grid->Width = Width;
+		Grid->Height = Height;
+		Grid->RegisterComponent();
+		return Grid;
+	}
+
+	// Does every placement cover exactly its cells inside the grid, without
+	// overlapping another, and hold an owned item?
+	bool IsConsistent(const UInventoryGrid& Grid)
+	{
+		int32 NumPlacedCells = 0;
+		for (const FInventoryGridPlacement& Placement : Grid.GetPlacements())
+		{
+			if (Placement.Position.X < 0 || Placement.Position.Y < 0 || Placement.Position.X + Placement.Size.X > Grid.Width
+				|| Placement.Position.Y + Placement.Size.Y > Grid.Height || Grid.GetInventory()->GetItemQuantity(Placement.ItemId) <= 0)
+				return false;
+
+			for (int32 Y = Placement.Position.Y; Y < Placement.Position.Y + Placement.Size.Y; ++Y)
+			{
+				for (int32 X = Placement.Position.X; X < Placement.Position.X + Placement.Size.X; ++X)
+				{
+					if (!(Grid.GetItemAt(FIntPoint(X, Y)) == Placement.ItemId))
+						return false;
+				}
+			}
+			NumPlacedCells += Placement.Size.X * Placement.Size.Y;
+		}
+
+		int32 NumOccupiedCells = 0;
+		for (int32 Y = 0; Y < Grid.Height; ++Y)
+		{
+			for (int32 X = 0; X < Grid.Width; ++X)
+			{
+				NumOccupiedCells += Grid.IsAreaFree(FIntPoint(X, Y), FIntPoint(1, 1)) ? 0 : 1;
+			}
+		}
+
+		return NumOccupiedCells == NumPlacedCells;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryGridPlacementTest, "InventorySystem.Grid.Placement",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryGridPlacementTest::RunTest(const FString& Parameters)
+{
+	InventoryTests::FTestWorld TestWorld;
+	UInventoryWorldSubsystem* Subsystem = TestWorld.GetSubsystem();
+	if (!TestNotNull(TEXT("World subsystem"), Subsystem))
+		return false;
+
+	UInventoryGrid* Grid = SpawnGrid(TestWorld, 4, 3);
+	UInventory* Inventory = Grid->GetInventory();
+	if (!TestNotNull(TEXT("Grid inventory"), Inventory))
+		return false;
+
+	// Footprints are clamped and only set for item types of the inventory
+	const FInventoryItemId Square(1), Tall(2), Large(3), Small(4), Other(5), Single(7);
+	TestEqual(TEXT("Footprint of an unknown item"), (int32)Grid->SetItemFootprint(TEXT("NotAnItem"), FIntPoint(2, 2)),
+		(int32)InventoryError::EInvalidItemType);
+	Grid->SetItemFootprint(Other, FIntPoint(100, 0));
+	TestTrue(TEXT("Clamped footprint"), Grid->GetItemFootprint(Other) == FIntPoint(UInventoryGrid::MaxWidth, 1));
+	Grid->SetItemFootprint(Other, FIntPoint(1, 1));
+
+	TestEqual(TEXT("Footprint by name"), (int32)Grid->SetItemFootprint(InventoryTests::GetItemName(Square.Index), FIntPoint(2, 2)),
+		(int32)InventoryError::ESuccess);
+	Grid->SetItemFootprint(Tall, FIntPoint(2, 3));
+	Grid->SetItemFootprint(Large, FIntPoint(2, 2));
+
+	// Item types take their footprint when first added, more of a placed
+	// item type needs no space
+	TestEqual(TEXT("Add a square item"), (int32)Grid->AddItem(Square), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Add a tall item"), (int32)Grid->AddItem(Tall), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Add more of a placed item"), (int32)Grid->AddItem(Square, 2), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Placements"), Grid->GetPlacements().Num(), 2);
+	TestTrue(TEXT("Tall item placed on the right"), Grid->FindPlacement(Tall) && Grid->FindPlacement(Tall)->Position == FIntPoint(2, 0));
+	TestTrue(TEXT("Consistent grid"), IsConsistent(*Grid));
+
+	// Items that do not fit, even after rearranging, are not added and
+	// leave the grid as it was
+	const FIntPoint SquarePosition = Grid->FindPlacement(Square)->Position;
+	TestFalse(TEXT("Large item fits"), Grid->CanFitItem(Large));
+	TestEqual(TEXT("Add a large item"), (int32)Grid->AddItem(Large), (int32)InventoryError::ENoSpace);
+	TestEqual(TEXT("Quantity of an item without space"), Inventory->GetItemQuantity(Large), 0);
+	TestTrue(TEXT("Grid unchanged by an item without space"), Grid->GetPlacements().Num() == 2 && Grid->FindPlacement(Square)->Position == SquarePosition
+		&& Grid->FindPlacement(Tall)->Position == FIntPoint(2, 0));
+
+	// The inventory's own errors come first
+	TestEqual(TEXT("Add above the maximum"), (int32)Grid->AddItem(Small, 100), (int32)InventoryError::EMaxQuantityExceeded);
+	TestEqual(TEXT("Add an unknown item"), (int32)Grid->AddItem(TEXT("NotAnItem")), (int32)InventoryError::EInvalidItemType);
+	TestNull(TEXT("No placement after a failed add"), Grid->FindPlacement(Small));
+
+	// Fill the grid up
+	TestEqual(TEXT("Add a small item"), (int32)Grid->AddItem(Small), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Add another small item"), (int32)Grid->AddItem(Other), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Add to a full grid"), (int32)Grid->AddItem(Single), (int32)InventoryError::ENoSpace);
+	TestTrue(TEXT("Consistent full grid"), IsConsistent(*Grid));
+
+	// Items the inventory loses or gains by itself are removed or placed at
+	// the end of the frame
+	const FIntPoint SmallPosition = Grid->FindPlacement(Small)->Position;
+	Inventory->ConsumeItem(Small, 1);
+	Subsystem->Tick(0.1f);
+	TestNull(TEXT("Consumed item removed"), Grid->FindPlacement(Small));
+	TestTrue(TEXT("Cell of the consumed item free"), Grid->IsAreaFree(SmallPosition, FIntPoint(1, 1)));
+
+	Inventory->AddItem(Single, 1);
+	Subsystem->Tick(0.1f);
+	TestTrue(TEXT("Item added by the inventory placed"), Grid->GetItemAt(SmallPosition) == Single);
+	TestTrue(TEXT("Consistent grid after the inventory changed"), IsConsistent(*Grid));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryGridArrangeTest, "InventorySystem.Grid.AutoArrange",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryGridArrangeTest::RunTest(const FString& Parameters)
+{
+	InventoryTests::FTestWorld TestWorld;
+	UInventoryGrid* Grid = SpawnGrid(TestWorld, 3, 2);
+	if (!TestNotNull(TEXT("Grid inventory"), Grid->GetInventory()))
+		return false;
+
+	// Two single cells in the middle column leave no free row for a wide
+	// item, though there are enough free cells for it
+	const FInventoryItemId Top(1), Bottom(2), Wide(3);
+	Grid->SetItemFootprint(Wide, FIntPoint(3, 1));
+	Grid->AddItem(Top);
+	Grid->AddItem(Bottom);
+	TestTrue(TEXT("Move to the top middle"), Grid->MoveItem(Top, FIntPoint(1, 0)));
+	TestTrue(TEXT("Move to the bottom middle"), Grid->MoveItem(Bottom, FIntPoint(1, 1)));
+	TestFalse(TEXT("Move onto another item"), Grid->MoveItem(Bottom, FIntPoint(1, 0)));
+	TestFalse(TEXT("Move out of the grid"), Grid->MoveItem(Bottom, FIntPoint(3, 1)));
+	TestFalse(TEXT("Move of an item that is not placed"), Grid->MoveItem(Wide, FIntPoint(0, 0)));
+	TestTrue(TEXT("Item stays after failed moves"), Grid->FindPlacement(Bottom)->Position == FIntPoint(1, 1));
+
+	Grid->bAutoArrange = false;
+	TestFalse(TEXT("Wide item fits as it is"), Grid->CanFitItem(Wide));
+	TestEqual(TEXT("Add a wide item without rearranging"), (int32)Grid->AddItem(Wide), (int32)InventoryError::ENoSpace);
+	TestTrue(TEXT("Grid unchanged without rearranging"), Grid->FindPlacement(Top)->Position == FIntPoint(1, 0)
+		&& Grid->FindPlacement(Bottom)->Position == FIntPoint(1, 1));
+
+	// Rearranging makes room
+	Grid->bAutoArrange = true;
+	TestEqual(TEXT("Add a wide item with rearranging"), (int32)Grid->AddItem(Wide), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Placements after rearranging"), Grid->GetPlacements().Num(), 3);
+	TestTrue(TEXT("Consistent grid after rearranging"), IsConsistent(*Grid));
+	TestTrue(TEXT("Rearranging again keeps everything"), Grid->AutoArrange() && IsConsistent(*Grid));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// The per item record UInventory kept in a map by name before its hot
+	// fields moved into parallel dense arrays
+	struct FReferenceItem
+	{
+		FInventoryItemDefinition Definition;
+		int32 Quantity = 0;
+		bool bEquipped = false;
+	};
+
+	InventoryError ApplyReferenceOp(FReferenceItem& Item, const FInventoryOp& Op)
+	{
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:
+			if (Item.Quantity + Op.Quantity > FMath::Max(Item.Definition.MaximumQuantity, 0))
+				return InventoryError::EMaxQuantityExceeded;
+			Item.Quantity += Op.Quantity;
+			return InventoryError::ESuccess;
+
+		case InventoryOpType::EConsume:
+			if (!Item.Definition.IsConsumable)
+				return InventoryError::ENotConsumable;
+			if (Item.Quantity == 0)
+				return InventoryError::ENoItemsToConsume;
+			Item.Quantity = FMath::Max(Item.Quantity - Op.Quantity, 0);
+			return InventoryError::ESuccess;
+
+		case InventoryOpType::EEquip:
+			if (!Item.Definition.IsEquippable)
+				return InventoryError::ENotEquippable;
+			if (Item.bEquipped)
+				return InventoryError::EAlreadyEquipped;
+			Item.bEquipped = true;
+			return InventoryError::ESuccess;
+
+		case InventoryOpType::EUnequip:
+			if (!Item.Definition.IsEquippable)
+				return InventoryError::ENotEquippable;
+			if (!Item.bEquipped)
+				return InventoryError::ENotEquipped;
+			Item.bEquipped = false;
+			return InventoryError::ESuccess;
+		}
+
+		return InventoryError::EInvalidItemType;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryItemStateLookupTest, "InventorySystem.ItemState.Lookups",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryItemStateLookupTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumItemTypes = 40;
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+
+	TMap<FString, FReferenceItem> Reference;
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		Reference.Add(InventoryTests::GetItemName(I)).Definition = InventoryTests::MakeItemDefinition(I);
+	}
+
+	// Mutate both through the name based API and compare every result
+	FRandomStream Random(3);
+	for (int32 Step = 0; Step < 4000; ++Step)
+	{
+		const FInventoryOp Op = InventoryTests::MakeRandomOp(Random, NumItemTypes);
+		const FString Name = InventoryTests::GetItemName(Op.ItemId.Index);
+
+		InventoryError Result = InventoryError::EInvalidItemType;
+		switch (Op.Type)
+		{
+		case InventoryOpType::EAdd:		Result = Inventory->AddItem(Name, Op.Quantity); break;
+		case InventoryOpType::EConsume:	Result = Inventory->ConsumeItem(Name, Op.Quantity); break;
+		case InventoryOpType::EEquip:	Result = Inventory->EquipItem(Name); break;
+		case InventoryOpType::EUnequip:	Result = Inventory->UnequipItem(Name); break;
+		}
+
+		if (!TestEqual(TEXT("Result of op"), (int32)Result, (int32)ApplyReferenceOp(Reference[Name], Op)))
+			return false;
+	}
+
+	TestEqual(TEXT("Unknown names"), (int32)Inventory->AddItem(TEXT("NotAnItem")), (int32)InventoryError::EInvalidItemType);
+	TestFalse(TEXT("Unknown names resolve"), Inventory->FindItemId(TEXT("NotAnItem")).IsValid());
+
+	int32 NumEquipped = 0;
+	for (const TPair<FString, FReferenceItem>& Pair : Reference)
+	{
+		const FReferenceItem& Expected = Pair.Value;
+		const FInventoryItemId ItemId = Inventory->FindItemId(Pair.Key);
+		NumEquipped += Expected.bEquipped;
+
+		FInventoryItem Item;
+		if (!TestTrue(TEXT("Item resolves"), Inventory->GetItem(ItemId, Item)))
+			continue;
+
+		TestEqual(TEXT("Name"), Item.Name, Expected.Definition.Name);
+		TestEqual(TEXT("Flavor text"), Item.FlavorText, Expected.Definition.FlavorText);
+		TestEqual(TEXT("Quantity"), Item.Quantity, Expected.Quantity);
+		TestEqual(TEXT("Quantity by id"), Inventory->GetItemQuantity(ItemId), Expected.Quantity);
+		TestEqual(TEXT("Maximum quantity"), Item.MaximumQuantity, FMath::Max(Expected.Definition.MaximumQuantity, 0));
+		TestEqual(TEXT("Consumable"), Item.IsConsumable, Expected.Definition.IsConsumable);
+		TestEqual(TEXT("Equippable"), Item.IsEquippable, Expected.Definition.IsEquippable);
+		TestEqual(TEXT("Equipped"), Item.IsEquipped, Expected.bEquipped);
+		TestEqual(TEXT("Equipped by id"), Inventory->IsItemEquipped(ItemId), Expected.bEquipped);
+		TestEqual(TEXT("Number of stats"), Item.StatsBoostsAndDurations.Num(), Expected.Definition.StatsBoostsAndDurations.Num());
+
+		for (const TPair<FString, FBoostAndDuration>& Stat : Expected.Definition.StatsBoostsAndDurations)
+		{
+			const FBoostAndDuration* Boost = Item.StatsBoostsAndDurations.Find(Stat.Key);
+			TestTrue(TEXT("Stat boost"), Boost && Boost->Boost == Stat.Value.Boost && Boost->Duration == Stat.Value.Duration);
+		}
+	}
+
+	const TArray<FInventoryItem> Items = Inventory->GetInventory();
+	TestEqual(TEXT("Number of items"), Items.Num(), Reference.Num());
+	for (const FInventoryItem& Item : Items)
+	{
+		const FReferenceItem* Expected = Reference.Find(Item.Name);
+		TestTrue(TEXT("Listed item"), Expected && Expected->Quantity == Item.Quantity && Expected->bEquipped == Item.IsEquipped);
+	}
+
+	const TArray<FInventoryItem> EquippedItems = Inventory->GetEquippedItems();
+	TestEqual(TEXT("Number of equipped items"), EquippedItems.Num(), NumEquipped);
+	for (const FInventoryItem& Item : EquippedItems)
+	{
+		const FReferenceItem* Expected = Reference.Find(Item.Name);
+		TestTrue(TEXT("Equipped item"), Expected && Expected->bEquipped);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryItemStatePerfTest, "InventorySystem.Perf.ItemState",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryItemStatePerfTest::RunTest(const FString& Parameters)
+{
+	// Every measurement touches about this many items, so small inventories
+	// are timed over many repeats
+	constexpr int32 NumItemsPerMeasurement = 10000000;
+
+	for (const int32 NumItemTypes : { 100, 10000, 100000 })
+	{
+		UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+
+		TMap<FString, FReferenceItem> Reference;
+		TArray<FString> Names;
+		TArray<FInventoryItemId> ItemIds;
+		FRandomStream Random(3);
+		for (int32 I = 0; I < NumItemTypes; ++I)
+		{
+			FReferenceItem& Item = Reference.Add(InventoryTests::GetItemName(I));
+			Item.Definition = InventoryTests::MakeItemDefinition(I);
+			Item.Quantity = Random.RandRange(0, FMath::Max(Item.Definition.MaximumQuantity, 0));
+			Item.bEquipped = Item.Definition.IsEquippable && Random.RandRange(0, 2) == 0;
+
+			const FInventoryItemId ItemId(I);
+			Inventory->AddItem(ItemId, Item.Quantity);
+			if (Item.bEquipped)
+				Inventory->EquipItem(ItemId);
+
+			// Point lookups in random order
+			Names.Add(InventoryTests::GetItemName(Random.RandRange(0, NumItemTypes - 1)));
+			ItemIds.Add(Inventory->FindItemId(Names.Last()));
+		}
+
+		const int32 NumRepeats = FMath::Max(NumItemsPerMeasurement / NumItemTypes, 1);
+		auto Measure = [NumRepeats, NumItemTypes](auto&& Scan, int64& OutResult)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+			{
+				OutResult = Scan();
+			}
+			return (FPlatformTime::Seconds() - StartTime) * 1e9 / (double(NumRepeats) * NumItemTypes);
+		};
+
+		// Total quantity and number of equipped items, what GetEquippedItems
+		// and bulk checks do per item
+		int64 MapScanResult = 0;
+		const double MapScanNs = Measure([&Reference]()
+		{
+			int64 Result = 0;
+			for (const TPair<FString, FReferenceItem>& Pair : Reference)
+			{
+				Result += Pair.Value.Quantity + (int64(Pair.Value.bEquipped) << 32);
+			}
+			return Result;
+		}, MapScanResult);
+
+		int64 DenseScanResult = 0;
+		const double DenseScanNs = Measure([Inventory]()
+		{
+			int64 Result = 0;
+			for (const int32 Quantity : Inventory->GetQuantities())
+			{
+				Result += Quantity;
+			}
+			return Result + (int64(Inventory->GetEquippedItemBits().CountSetBits()) << 32);
+		}, DenseScanResult);
+
+		int64 MapLookupResult = 0;
+		const double MapLookupNs = Measure([&Reference, &Names]()
+		{
+			int64 Result = 0;
+			for (const FString& Name : Names)
+			{
+				Result += Reference.FindChecked(Name).Quantity;
+			}
+			return Result;
+		}, MapLookupResult);
+
+		int64 DenseLookupResult = 0;
+		const double DenseLookupNs = Measure([Inventory, &ItemIds]()
+		{
+			int64 Result = 0;
+			for (const FInventoryItemId ItemId : ItemIds)
+			{
+				Result += Inventory->GetItemQuantity(ItemId);
+			}
+			return Result;
+		}, DenseLookupResult);
+
+		TestEqual(TEXT("Scans agree"), DenseScanResult, MapScanResult);
+		TestEqual(TEXT("Lookups agree"), DenseLookupResult, MapLookupResult);
+
+		AddInfo(FString::Printf(TEXT("%d item types, ns per item: map scan %.2f, dense scan %.2f, map lookup %.2f, dense lookup %.2f"),
+			NumItemTypes, MapScanNs, DenseScanNs, MapLookupNs, DenseLookupNs));
+
+		// Tiny inventories fit in cache either way
+		if (NumItemTypes >= 10000)
+		{
+			TestTrue(TEXT("Dense scan is faster than the map scan"), DenseScanNs < MapScanNs);
+			TestTrue(TEXT("Lookup by id is faster than lookup by name"), DenseLookupNs < MapLookupNs);
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Algo/Compare.h"
+#include "Algo/Reverse.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 60;
+
+	const InventoryItemFilter Filters[] = { InventoryItemFilter::EAll, InventoryItemFilter::EConsumable, InventoryItemFilter::EEquippable };
+
+	// The owned items passing Filter that boost StatId, highest boost first,
+	// found by walking every item type
+	TArray<FInventoryStatIndexEntry> GetOwnedItemsByStatReference(UInventory& Inventory, const int32 StatId, const InventoryItemFilter Filter)
+	{
+		const UInventoryCatalog* Catalog = Inventory.GetCatalog();
+
+		TArray<FInventoryStatIndexEntry> Entries;
+		for (int32 Index = 0; Index < Catalog->Num(); ++Index)
+		{
+			const FInventoryItemId ItemId(Index);
+			if (Inventory.GetItemQuantity(ItemId) == 0
+				|| (Filter == InventoryItemFilter::EConsumable && !Catalog->IsConsumable(ItemId))
+				|| (Filter == InventoryItemFilter::EEquippable && !Catalog->IsEquippable(ItemId)))
+				continue;
+
+			for (const FInventoryStatModifier& Modifier : Catalog->GetModifiers(ItemId))
+			{
+				if (Modifier.StatId == StatId)
+					Entries.Add({ Modifier.Boost, ItemId });
+			}
+		}
+
+		Entries.Sort(&FInventoryStatIndexEntry::Precedes);
+		return Entries;
+	}
+
+	// The owned items in the order of a page, found by sorting every owned
+	// item. Names and quantities ascend, boosts descend, ties by item id.
+	TArray<FInventoryItemId> GetPageOrderReference(UInventory& Inventory, const InventorySortKey SortKey, const int32 StatId)
+	{
+		const UInventoryCatalog* Catalog = Inventory.GetCatalog();
+
+		TArray<FInventoryItemId> ItemIds;
+		if (SortKey == InventorySortKey::EStatBoost)
+		{
+			for (const FInventoryStatIndexEntry& Entry : GetOwnedItemsByStatReference(Inventory, StatId, InventoryItemFilter::EAll))
+			{
+				ItemIds.Add(Entry.ItemId);
+			}
+			return ItemIds;
+		}
+
+		for (int32 Index = 0; Index < Catalog->Num(); ++Index)
+		{
+			if (Inventory.GetItemQuantity(FInventoryItemId(Index)) > 0)
+				ItemIds.Add(FInventoryItemId(Index));
+		}
+
+		ItemIds.Sort([&Inventory, Catalog, SortKey](const FInventoryItemId A, const FInventoryItemId B)
+		{
+			const int32 Order = SortKey == InventorySortKey::EName
+				? FString(Catalog->GetName(A)).Compare(FString(Catalog->GetName(B)), ESearchCase::IgnoreCase)
+				: Inventory.GetItemQuantity(A) - Inventory.GetItemQuantity(B);
+			return Order != 0 ? Order < 0 : A.Index < B.Index;
+		});
+		return ItemIds;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryOwnedByStatTest, "InventorySystem.OwnedIndex.ByStat",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryOwnedByStatTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	const UInventoryCatalog* Catalog = Inventory->GetCatalog();
+
+	// The indexes follow every change of the owned items, for every stat
+	// and filter
+	FRandomStream Random(21);
+	TArray<FInventoryOp> Ops;
+	for (int32 Round = 0; Round < 300; ++Round)
+	{
+		Ops.Reset();
+		for (int32 Step = 0; Step < 10; ++Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+		Inventory->ApplyOps(Ops);
+
+		for (const TCHAR* StatName : InventoryTests::StatNames)
+		{
+			const int32 StatId = Catalog->FindStatId(StatName);
+			for (const InventoryItemFilter Filter : Filters)
+			{
+				const TArray<FInventoryStatIndexEntry> Expected = GetOwnedItemsByStatReference(*Inventory, StatId, Filter);
+				if (!TestTrue(FString::Printf(TEXT("Owned items by %s, filter %d"), StatName, (int32)Filter),
+					Algo::Compare(Inventory->GetOwnedItemsByStat(StatId, Filter), Expected)))
+					return false;
+
+				const TArray<FInventoryItemId> Boosting = Inventory->GetOwnedItemsBoostingStat(StatName, Filter);
+				if (!TestEqual(TEXT("Owned items boosting a stat"), Boosting.Num(), Expected.Num()))
+					return false;
+
+				for (int32 Position = 0; Position < Expected.Num(); ++Position)
+				{
+					TestTrue(TEXT("Owned item boosting a stat"), Boosting[Position] == Expected[Position].ItemId);
+				}
+
+				const FInventoryItemId Best = Inventory->GetBestOwnedItemForStat(StatName, Filter);
+				TestTrue(TEXT("Best owned item for a stat"), Expected.Num() > 0 ? Best == Expected[0].ItemId : !Best.IsValid());
+			}
+		}
+	}
+
+	// Stats nobody has give nothing
+	TestEqual(TEXT("Owned items by an unknown stat id"), Inventory->GetOwnedItemsByStat(INDEX_NONE).Num(), 0);
+	TestEqual(TEXT("Owned items boosting an unknown stat"), Inventory->GetOwnedItemsBoostingStat(TEXT("Luck")).Num(), 0);
+	TestFalse(TEXT("Best owned item for an unknown stat"), Inventory->GetBestOwnedItemForStat(TEXT("Luck")).IsValid());
+
+	// Consuming every consumable item empties the consumable indexes
+	for (int32 Index = 0; Index < NumItemTypes; ++Index)
+	{
+		const FInventoryItemId ItemId(Index);
+		Inventory->UnequipItem(ItemId);
+		if (Catalog->IsConsumable(ItemId))
+			Inventory->ConsumeItem(ItemId, Inventory->GetItemQuantity(ItemId));
+	}
+	for (const TCHAR* StatName : InventoryTests::StatNames)
+	{
+		TestEqual(FString::Printf(TEXT("Consumable items boosting %s after consuming them"), StatName),
+			Inventory->GetOwnedItemsBoostingStat(StatName, InventoryItemFilter::EConsumable).Num(), 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryPagesTest, "InventorySystem.OwnedIndex.Pages",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryPagesTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	const UInventoryCatalog* Catalog = Inventory->GetCatalog();
+	const int32 HealthId = Catalog->FindStatId(TEXT("Health"));
+
+	// Pages of any size, read one after the other in either direction, add
+	// up to the whole order
+	auto CheckPages = [this, Inventory, HealthId](const TCHAR* When)
+	{
+		for (const InventorySortKey SortKey : { InventorySortKey::EName, InventorySortKey::EQuantity, InventorySortKey::EStatBoost })
+		{
+			const TArray<FInventoryItemId> Expected = GetPageOrderReference(*Inventory, SortKey, HealthId);
+			for (const bool bDescending : { false, true })
+			{
+				for (const int32 PageSize : { 1, 7, 100 })
+				{
+					TArray<FInventoryItemId> Pages;
+					TArray<FInventoryItemId> Page;
+					for (int32 Offset = 0; Offset <= Expected.Num(); Offset += PageSize)
+					{
+						if (!TestEqual(TEXT("Items in the order"), Inventory->GetInventoryPage(SortKey, HealthId, bDescending, Offset, PageSize, Page),
+							Expected.Num()))
+							return false;
+
+						Pages.Append(Page);
+					}
+
+					TArray<FInventoryItemId> ExpectedPages = Expected;
+					if (bDescending)
+						Algo::Reverse(ExpectedPages);
+
+					if (!TestTrue(FString::Printf(TEXT("Pages of %d by key %d, %s, %s"), PageSize, (int32)SortKey,
+						bDescending ? TEXT("descending") : TEXT("ascending"), When), Pages == ExpectedPages))
+						return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	FRandomStream Random(23);
+	TArray<FInventoryOp> Ops;
+	for (int32 Round = 0; Round < 100; ++Round)
+	{
+		Ops.Reset();
+		for (int32 Step = 0; Step < 10; ++Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+		Inventory->ApplyOps(Ops);
+
+		if (!CheckPages(TEXT("after random ops")))
+			return false;
+	}
+
+	// Item types added later sort by name among the owned ones, whatever
+	// their item id
+	FBoostAndDuration Boost;
+	Boost.Boost = 3;
+	for (const TCHAR* Name : { TEXT("aardvark"), TEXT("Middle"), TEXT("ZEBRA") })
+	{
+		Inventory->AddInventoryItemType(Name, TEXT(""), nullptr, nullptr, { { TEXT("Health"), Boost } }, 10);
+		Inventory->AddItem(Name, 2);
+		if (!CheckPages(*FString::Printf(TEXT("after adding %s"), Name)))
+			return false;
+	}
+
+	// Pages outside of the order are empty
+	TArray<FInventoryItemId> Page;
+	const int32 NumOwned = Inventory->GetInventoryPage(InventorySortKey::EName, INDEX_NONE, false, 0, 1, Page);
+	Inventory->GetInventoryPage(InventorySortKey::EName, INDEX_NONE, false, NumOwned, 5, Page);
+	TestEqual(TEXT("Page after the end"), Page.Num(), 0);
+	Inventory->GetInventoryPage(InventorySortKey::EName, INDEX_NONE, false, 0, 0, Page);
+	TestEqual(TEXT("Page of no items"), Page.Num(), 0);
+	Inventory->GetInventoryPage(InventorySortKey::EName, INDEX_NONE, false, 0, -3, Page);
+	TestEqual(TEXT("Page of a negative count"), Page.Num(), 0);
+	TestEqual(TEXT("Order of an unknown stat"), Inventory->GetInventoryPage(InventorySortKey::EStatBoost, INDEX_NONE, false, 0, 5, Page), 0);
+
+	// The blueprint version fills in the items of the page
+	const TArray<FInventoryItem> Items = Inventory->GetInventoryPage(InventorySortKey::EStatBoost, TEXT("Health"), false, 0, 3);
+	Inventory->GetInventoryPage(InventorySortKey::EStatBoost, HealthId, false, 0, 3, Page);
+	if (!TestEqual(TEXT("Items of a page"), Items.Num(), Page.Num()))
+		return false;
+
+	for (int32 Position = 0; Position < Items.Num(); ++Position)
+	{
+		TestEqual(TEXT("Item of a page"), Items[Position].Name, FString(Catalog->GetName(Page[Position])));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryReplication.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 60;
+
+	// Test item type 6 has a maximum quantity of 0 and is equippable
+	const FInventoryItemId ZeroMaximumItemId(6);
+
+	// Sends one delta from Authority to Receiver through a bit stream
+	bool SendDelta(const UInventory& Authority, UInventory& Receiver, int64& InOutAckedGeneration, int64& InOutReceivedGeneration)
+	{
+		FBitWriter Writer(0, true);
+		const int64 Generation = FInventoryDeltaSerializer::WriteDelta(Authority, InOutAckedGeneration, Writer);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		if (!FInventoryDeltaSerializer::ReadDelta(Receiver, Reader, InOutReceivedGeneration))
+			return false;
+
+		InOutAckedGeneration = Generation;
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryReplicationLoopbackTest, "InventorySystem.Replication.Loopback",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryReplicationLoopbackTest::RunTest(const FString& Parameters)
+{
+	UInventory* Authority = InventoryTests::MakeInventory(NumItemTypes);
+	UInventory* Receiver = InventoryTests::MakeInventory(NumItemTypes, Authority->GetCatalog());
+
+	TestEqual(TEXT("Zero maximum item type"), Authority->GetCatalog()->GetMaximumQuantity(ZeroMaximumItemId), 0);
+	TestEqual(TEXT("Zero maximum item equips"), (int32)Authority->EquipItem(ZeroMaximumItemId), (int32)InventoryError::ESuccess);
+
+	int64 AckedGeneration = 0;
+	int64 ReceivedGeneration = 0;
+
+	FRandomStream Random(16);
+	TArray<FInventoryOp> Ops;
+	TArray<InventoryError> Results;
+	for (int32 Round = 0; Round < 50; ++Round)
+	{
+		Ops.Reset();
+		for (int32 Step = Random.RandRange(0, 40); Step > 0; --Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+		Authority->ApplyOps(Ops, Results);
+
+		if (!TestTrue(TEXT("Delta applies"), SendDelta(*Authority, *Receiver, AckedGeneration, ReceivedGeneration)))
+			return false;
+
+		TestTrue(TEXT("Receiver matches the authority"), InventoryTests::HaveSameState(*Authority, *Receiver, NumItemTypes));
+		TestEqual(TEXT("Acked generation"), AckedGeneration, Authority->GetGeneration());
+		TestEqual(TEXT("Received generation"), ReceivedGeneration, AckedGeneration);
+	}
+
+	// A delta that arrives after a newer one changes nothing
+	FBitWriter StaleWriter(0, true);
+	FInventoryDeltaSerializer::WriteDelta(*Authority, 0, StaleWriter);
+
+	for (int32 Index = 0; Index < NumItemTypes && Authority->GetGeneration() == AckedGeneration; ++Index)
+	{
+		Authority->AddItem(FInventoryItemId(Index));
+	}
+	TestTrue(TEXT("Newer delta applies"), SendDelta(*Authority, *Receiver, AckedGeneration, ReceivedGeneration));
+
+	FBitReader StaleReader(StaleWriter.GetData(), StaleWriter.GetNumBits());
+	TestTrue(TEXT("Stale delta is ignored"), FInventoryDeltaSerializer::ReadDelta(*Receiver, StaleReader, ReceivedGeneration));
+	TestTrue(TEXT("Stale delta changes nothing"), InventoryTests::HaveSameState(*Authority, *Receiver, NumItemTypes));
+	TestEqual(TEXT("Generation after a stale delta"), ReceivedGeneration, AckedGeneration);
+
+	// A fresh receiver catches up from generation 0 in one delta
+	UInventory* LateReceiver = InventoryTests::MakeInventory(NumItemTypes, Authority->GetCatalog());
+	int64 LateAckedGeneration = 0;
+	int64 LateReceivedGeneration = 0;
+	TestTrue(TEXT("Full delta applies"), SendDelta(*Authority, *LateReceiver, LateAckedGeneration, LateReceivedGeneration));
+	TestTrue(TEXT("Late receiver matches the authority"), InventoryTests::HaveSameState(*Authority, *LateReceiver, NumItemTypes));
+
+	// Negative quantities are sent as 0
+	const FInventoryItemId ItemId(1);
+	Authority->ConsumeItem(ItemId, MAX_int32);
+	Authority->AddItem(ItemId, -3);
+	TestTrue(TEXT("Delta with a negative quantity applies"), SendDelta(*Authority, *Receiver, AckedGeneration, ReceivedGeneration));
+	TestEqual(TEXT("Negative quantity"), Receiver->GetItemQuantity(ItemId), 0);
+
+	// Truncated deltas are rejected without changing anything
+	Authority->AddItem(ItemId, 4);
+	FBitWriter Writer(0, true);
+	FInventoryDeltaSerializer::WriteDelta(*Authority, AckedGeneration, Writer);
+	for (int64 NumBits = 0; NumBits < Writer.GetNumBits(); ++NumBits)
+	{
+		int64 Generation = ReceivedGeneration;
+		FBitReader Reader(Writer.GetData(), NumBits);
+		if (!TestFalse(TEXT("Truncated delta applies"), FInventoryDeltaSerializer::ReadDelta(*Receiver, Reader, Generation)))
+			break;
+	}
+	TestEqual(TEXT("Truncated deltas change nothing"), Receiver->GetItemQuantity(ItemId), 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 50;
+
+	// Writes a saved state by hand, see UInventory::SaveState for the format
+	struct FSaveStateWriter
+	{
+		TArray<uint8> Data;
+
+		void WriteFixed(const uint64 Value, const int32 NumBytes)
+		{
+			for (int32 Byte = 0; Byte < NumBytes; ++Byte)
+			{
+				Data.Add(uint8(Value >> (8 * Byte)));
+			}
+		}
+
+		void WriteVarint(uint64 Value)
+		{
+			for (; Value >= 0x80; Value >>= 7)
+			{
+				Data.Add(uint8(Value) | 0x80);
+			}
+			Data.Add(uint8(Value));
+		}
+
+		void WriteHeader(UInventoryCatalog* Catalog, const uint64 NumSaved)
+		{
+			WriteFixed(0x56415349, 4);
+			WriteVarint(1);
+			WriteFixed(Catalog->GetFingerprint(), 8);
+			WriteVarint(NumSaved);
+		}
+
+		void WriteItem(const uint64 Delta, const uint64 Quantity, const bool bEquipped)
+		{
+			WriteVarint(Delta);
+			WriteVarint((Quantity << 1) | (bEquipped ? 1 : 0));
+		}
+	};
+
+	UInventory* MakeInventoryWithRandomState(const int32 Seed, UInventoryCatalog* Catalog = nullptr)
+	{
+		UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes, Catalog);
+
+		FRandomStream Random(Seed);
+		TArray<InventoryError> Results;
+		TArray<FInventoryOp> Ops;
+		for (int32 Step = 0; Step < 500; ++Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+		Inventory->ApplyOps(Ops, Results);
+
+		return Inventory;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySaveStateRoundTripTest, "InventorySystem.SaveState.RoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySaveStateRoundTripTest::RunTest(const FString& Parameters)
+{
+	UInventory* Saved = MakeInventoryWithRandomState(1);
+	UInventory* Loaded = MakeInventoryWithRandomState(2, Saved->GetCatalog());
+	TestFalse(TEXT("Inventories start out different"), InventoryTests::HaveSameState(*Saved, *Loaded, NumItemTypes));
+
+	TArray<uint8> Data;
+	Saved->SaveState(Data);
+
+	TestTrue(TEXT("State loads"), Loaded->LoadState(Data));
+	TestTrue(TEXT("Loaded state equals saved state"), InventoryTests::HaveSameState(*Saved, *Loaded, NumItemTypes));
+	TestTrue(TEXT("Equipped stat totals follow the loaded state"), Loaded->ValidateEquippedStatTotals());
+
+	// Saving the loaded state gives back the same bytes
+	TArray<uint8> ReloadedData;
+	Loaded->SaveState(ReloadedData);
+	TestTrue(TEXT("Saved again"), ReloadedData == Data);
+
+	// An empty inventory saves to a state that clears everything
+	UInventory* Empty = InventoryTests::MakeInventory(NumItemTypes, Saved->GetCatalog());
+	Empty->SaveState(Data);
+	TestTrue(TEXT("Empty state loads"), Loaded->LoadState(Data));
+	TestTrue(TEXT("Empty state clears the inventory"), InventoryTests::HaveSameState(*Empty, *Loaded, NumItemTypes));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySaveStateCorruptTest, "InventorySystem.SaveState.CorruptInput",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySaveStateCorruptTest::RunTest(const FString& Parameters)
+{
+	UInventory* Saved = MakeInventoryWithRandomState(1);
+	UInventory* Loaded = MakeInventoryWithRandomState(2, Saved->GetCatalog());
+	UInventory* Unchanged = MakeInventoryWithRandomState(2, Saved->GetCatalog());
+	UInventoryCatalog* Catalog = Saved->GetCatalog();
+
+	TArray<uint8> Data;
+	Saved->SaveState(Data);
+
+	// Every truncation is rejected and leaves the inventory as it was
+	for (int32 Length = 0; Length < Data.Num(); ++Length)
+	{
+		if (!TestFalse(TEXT("Truncated state loads"), Loaded->LoadState(TConstArrayView<uint8>(Data.GetData(), Length))))
+			break;
+	}
+	TestTrue(TEXT("Truncated states change nothing"), InventoryTests::HaveSameState(*Loaded, *Unchanged, NumItemTypes));
+
+	// Trailing bytes
+	TArray<uint8> Padded = Data;
+	Padded.Add(0);
+	TestFalse(TEXT("State with trailing bytes loads"), Loaded->LoadState(Padded));
+
+	// An id delta past the last item type
+	{
+		FSaveStateWriter Writer;
+		Writer.WriteHeader(Catalog, 2);
+		Writer.WriteItem(1, 0, false);
+		Writer.WriteItem(NumItemTypes, 1, false);
+		TestFalse(TEXT("Out of range id delta loads"), Loaded->LoadState(Writer.Data));
+	}
+
+	// An id delta so large the id overflows
+	{
+		FSaveStateWriter Writer;
+		Writer.WriteHeader(Catalog, 1);
+		Writer.WriteItem(MAX_uint64 >> 1, 1, false);
+		TestFalse(TEXT("Overflowing id delta loads"), Loaded->LoadState(Writer.Data));
+	}
+
+	// A quantity above the maximum of its item type
+	{
+		const FInventoryItemId ItemId(1);
+		const int32 MaximumQuantity = Catalog->GetMaximumQuantity(ItemId);
+
+		FSaveStateWriter Writer;
+		Writer.WriteHeader(Catalog, 1);
+		Writer.WriteItem(ItemId.Index, MaximumQuantity + 1, false);
+		TestFalse(TEXT("Quantity above the maximum loads"), Loaded->LoadState(Writer.Data));
+
+		// The same entry at the maximum is fine
+		Writer.Data.Reset();
+		Writer.WriteHeader(Catalog, 1);
+		Writer.WriteItem(ItemId.Index, MaximumQuantity, false);
+		TestTrue(TEXT("Quantity at the maximum loads"), Loaded->LoadState(Writer.Data));
+		TestEqual(TEXT("Loaded quantity"), Loaded->GetItemQuantity(ItemId), MaximumQuantity);
+		Unchanged->LoadState(Writer.Data);
+	}
+
+	// Equipping an item type that is not equippable
+	{
+		FSaveStateWriter Writer;
+		Writer.WriteHeader(Catalog, 1);
+		Writer.WriteItem(1, 0, true);
+		TestFalse(TEXT("Equipped non equippable item loads"), Loaded->LoadState(Writer.Data));
+	}
+
+	// A state saved against another catalog
+	{
+		FSaveStateWriter Writer;
+		Writer.WriteFixed(0x56415349, 4);
+		Writer.WriteVarint(1);
+		Writer.WriteFixed(Catalog->GetFingerprint() ^ 1, 8);
+		Writer.WriteVarint(0);
+		TestFalse(TEXT("State of another catalog loads"), Loaded->LoadState(Writer.Data));
+	}
+
+	TestTrue(TEXT("Rejected states change nothing"), InventoryTests::HaveSameState(*Loaded, *Unchanged, NumItemTypes));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySaveStatePerfTest, "InventorySystem.Perf.SaveState",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventorySaveStatePerfTest::RunTest(const FString& Parameters)
+{
+	// Every measurement saves or loads about this many entries, so small
+	// inventories are timed over many repeats
+	constexpr int32 NumEntriesPerMeasurement = 2000000;
+
+	for (const int32 NumEntries : { 10, 100, 1000, 10000, 100000 })
+	{
+		// One in seven test item types has a maximum quantity of 0, every 
+		// other one gets items and becomes an entry of the saved state
+		const int32 NumTypes = NumEntries * 7 / 6 + 1;
+		UInventory* Saved = InventoryTests::MakeInventory(NumTypes);
+		UInventory* Loaded = InventoryTests::MakeInventory(NumTypes, Saved->GetCatalog());
+
+		FRandomStream Random(15);
+		int32 NumSaved = 0;
+		for (int32 I = 0; I < NumTypes && NumSaved < NumEntries; ++I)
+		{
+			const FInventoryItemId ItemId(I);
+			const int32 MaximumQuantity = Saved->GetCatalog()->GetMaximumQuantity(ItemId);
+			if (MaximumQuantity == 0)
+				continue;
+
+			Saved->AddItem(ItemId, Random.RandRange(1, MaximumQuantity));
+			if (Random.RandRange(0, 3) == 0)
+				Saved->EquipItem(ItemId);
+			++NumSaved;
+		}
+
+		const int32 NumRepeats = FMath::Max(NumEntriesPerMeasurement / NumSaved, 1);
+		TArray<uint8> Data;
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			Saved->SaveState(Data);
+		}
+		const double SaveSeconds = (FPlatformTime::Seconds() - StartTime) / NumRepeats;
+
+		bool bLoaded = true;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			bLoaded &= Loaded->LoadState(Data);
+		}
+		const double LoadSeconds = (FPlatformTime::Seconds() - StartTime) / NumRepeats;
+
+		TestTrue(TEXT("State loads"), bLoaded);
+		TestTrue(TEXT("Loaded state equals saved state"), InventoryTests::HaveSameState(*Saved, *Loaded, NumTypes));
+
+		AddInfo(FString::Printf(TEXT("%d entries: %d bytes (%.2f per entry), save %.1f us (%.1f M entries/s), load %.1f us (%.1f M entries/s)"),
+			NumSaved, Data.Num(), double(Data.Num()) / NumSaved, SaveSeconds * 1e6, NumSaved / SaveSeconds * 1e-6,
+			LoadSeconds * 1e6, NumSaved / LoadSeconds * 1e-6));
+
+		// A header of at most 24 bytes, then a one byte id delta and a one 
+		// byte quantity for the small quantities of the test item types
+		TestTrue(TEXT("Saved state size"), Data.Num() <= 24 + 2 * NumSaved);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Algo/Sort.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Names made of random syllables in mixed case, so short sequences are
+	// shared by many names and the longer ones by few
+	FString MakeSearchName(FRandomStream& Random, const int32 I)
+	{
+		static const TCHAR* const Syllables[] = { TEXT("an"), TEXT("Bel"), TEXT("cor"), TEXT("DRA"), TEXT("el"), TEXT("fi"), TEXT("Gor"),
+			TEXT("hal"), TEXT("is"), TEXT("Kan"), TEXT("lo"), TEXT("mir"), TEXT("Nu"), TEXT("or"), TEXT("pe"), TEXT("qua"), TEXT("Ros"),
+			TEXT("sa"), TEXT("Tor"), TEXT("ul"), TEXT("ve"), TEXT("wyn"), TEXT("xe"), TEXT("Yr"), TEXT("zo") };
+
+		FString Name;
+		for (int32 Count = Random.RandRange(2, 4); Count > 0; --Count)
+		{
+			Name += Syllables[Random.RandRange(0, int32(UE_ARRAY_COUNT(Syllables)) - 1)];
+		}
+
+		// Unique whatever the syllables, and never equal when folded
+		return FString::Printf(TEXT("%s %d"), *Name, I);
+	}
+
+	/** Creates an inventory with NumItemTypes searchable item types, owning
+	 * one item of every OwnedEvery-th type.
+	 */
+	UInventory* MakeSearchInventory(const int32 NumItemTypes, const int32 OwnedEvery)
+	{
+		UInventory* Inventory = NewObject<UInventory>();
+
+		FRandomStream Random(22);
+		TArray<FInventoryItemDefinition> Definitions;
+		Definitions.Reserve(NumItemTypes);
+		for (int32 I = 0; I < NumItemTypes; ++I)
+		{
+			FInventoryItemDefinition& Definition = Definitions.AddDefaulted_GetRef();
+			Definition.Name = MakeSearchName(Random, I);
+			Definition.MaximumQuantity = 10;
+		}
+
+		TArray<FInventoryItemId> ItemIds;
+		TArray<InventoryError> Results;
+		Inventory->AddInventoryItemTypes(MoveTemp(Definitions), ItemIds, Results);
+
+		for (int32 I = 0; I < NumItemTypes; I += OwnedEvery)
+		{
+			Inventory->AddItem(FInventoryItemId(I));
+		}
+
+		return Inventory;
+	}
+
+	// What SearchItems should return, found by folding and comparing every name
+	TArray<FInventoryItemId> SearchReference(UInventory& Inventory, const int32 NumItemTypes, const FString& Query, const bool bPrefix, const int32 MaxResults)
+	{
+		const FString FoldedQuery = Query.ToLower();
+		UInventoryCatalog* Catalog = Inventory.GetCatalog();
+
+		TArray<FInventoryItemId> Matches;
+		for (int32 I = 0; I < NumItemTypes; ++I)
+		{
+			const FInventoryItemId ItemId(I);
+			const FString FoldedName = FString(Catalog->GetName(ItemId)).ToLower();
+			if (Inventory.GetItemQuantity(ItemId) > 0
+				&& (bPrefix ? FoldedName.StartsWith(FoldedQuery, ESearchCase::CaseSensitive) : FoldedName.Contains(FoldedQuery, ESearchCase::CaseSensitive)))
+				Matches.Add(ItemId);
+		}
+
+		if (bPrefix)
+		{
+			Algo::Sort(Matches, [Catalog](const FInventoryItemId A, const FInventoryItemId B)
+			{
+				return FString(Catalog->GetName(A)).ToLower().Compare(FString(Catalog->GetName(B)).ToLower(), ESearchCase::CaseSensitive) < 0;
+			});
+		}
+
+		if (Matches.Num() > MaxResults)
+			Matches.SetNum(MaxResults);
+
+		return Matches;
+	}
+
+	const TCHAR* const SearchQueries[] = { TEXT(""), TEXT("a"), TEXT("Z"), TEXT("7"), TEXT("or"), TEXT("Dr"), TEXT("q"), TEXT("nor"),
+		TEXT("belcor"), TEXT("DRAel"), TEXT("an 1"), TEXT(" 4"), TEXT("xyz"), TEXT("wynwyn") };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySearchResultsTest, "InventorySystem.Search.Results",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySearchResultsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumItemTypes = 2000;
+
+	// Few owned items walk the owned items for short queries, many walk the
+	// short sequence lists
+	for (const int32 OwnedEvery : { 1, 3, 400 })
+	{
+		UInventory* Inventory = MakeSearchInventory(NumItemTypes, OwnedEvery);
+
+		for (const TCHAR* Query : SearchQueries)
+		{
+			for (const bool bPrefix : { false, true })
+			{
+				for (const int32 MaxResults : { 5, 100000 })
+				{
+					const TArray<FInventoryItemId> Found = Inventory->SearchItems(Query, bPrefix, MaxResults);
+					const TArray<FInventoryItemId> Expected = SearchReference(*Inventory, NumItemTypes, Query, bPrefix, MaxResults);
+					if (!TestTrue(FString::Printf(TEXT("%s search for '%s', max %d, owning every %d"), bPrefix ? TEXT("Prefix") : TEXT("Substring"),
+						Query, MaxResults, OwnedEvery), Found == Expected))
+						return false;
+				}
+			}
+		}
+	}
+
+	// Item types added after a search are found by the next one
+	UInventory* Inventory = MakeSearchInventory(10, 1);
+	Inventory->SearchItems(TEXT("a"));
+	Inventory->AddInventoryItemType(TEXT("Qx"), TEXT(""), nullptr, nullptr, {});
+	Inventory->AddItem(TEXT("Qx"));
+	TestEqual(TEXT("Short search for a new item type"), Inventory->SearchItems(TEXT("qX")).Num(), 1);
+	TestEqual(TEXT("Prefix search for a new item type"), Inventory->SearchItems(TEXT("QX"), true).Num(), 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySearchPerfTest, "InventorySystem.Perf.Search",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventorySearchPerfTest::RunTest(const FString& Parameters)
+{
+	// The target: a keystroke, i.e. one search for the first 100 matches,
+	// answers in under 100 microseconds with 50k item types
+	constexpr int32 NumItemTypes = 50000;
+	constexpr int32 MaxResults = 100;
+	constexpr int32 NumRepeats = 200;
+	constexpr double TargetSeconds = 100e-6;
+
+	for (const int32 OwnedEvery : { 1, 10, 1000 })
+	{
+		UInventory* Inventory = MakeSearchInventory(NumItemTypes, OwnedEvery);
+
+		// The indexes are built once after the catalog is filled, not by the first keystroke
+		Inventory->GetCatalog()->BuildNameIndexes();
+
+		for (const TCHAR* Query : SearchQueries)
+		{
+			for (const bool bPrefix : { false, true })
+			{
+				TArray<FInventoryItemId> Found;
+				Inventory->SearchItems(Query, bPrefix, MaxResults, Found);
+				if (!TestTrue(TEXT("Search results"), Found == SearchReference(*Inventory, NumItemTypes, Query, bPrefix, MaxResults)))
+					return false;
+
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+				{
+					Inventory->SearchItems(Query, bPrefix, MaxResults, Found);
+				}
+				const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumRepeats;
+
+				AddInfo(FString::Printf(TEXT("%s search for '%s' owning every %d: %.1f us, %d results"),
+					bPrefix ? TEXT("Prefix") : TEXT("Substring"), Query, OwnedEvery, Seconds * 1e6, Found.Num()));
+				TestTrue(FString::Printf(TEXT("'%s' searched within the target"), Query), Seconds < TargetSeconds);
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
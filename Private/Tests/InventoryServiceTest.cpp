@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Async/Async.h"
+#include "InventoryService.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 30;
+	constexpr int32 NumPlayers = 512;
+	constexpr int32 NumOpsPerPlayer = 200;
+
+	// Applies the random operations of one player, seeded by the player id
+	// so every service sees the same sequence
+	void ApplyPlayerOps(FInventoryService& Service, const uint64 PlayerId)
+	{
+		FRandomStream Random(int32(PlayerId));
+		TArray<FInventoryOp> Ops;
+		TArray<InventoryError> Results;
+		for (int32 Step = 0; Step < NumOpsPerPlayer; ++Step)
+		{
+			const FInventoryOp Op = InventoryTests::MakeRandomOp(Random, NumItemTypes);
+			if (Step % 2 == 0)
+			{
+				Ops.Add(Op);
+				continue;
+			}
+
+			switch (Op.Type)
+			{
+			case InventoryOpType::EAdd:		Service.AddItem(PlayerId, Op.ItemId, Op.Quantity); break;
+			case InventoryOpType::EConsume:	Service.ConsumeItem(PlayerId, Op.ItemId, Op.Quantity); break;
+			case InventoryOpType::EEquip:	Service.EquipItem(PlayerId, Op.ItemId); break;
+			case InventoryOpType::EUnequip:	Service.UnequipItem(PlayerId, Op.ItemId); break;
+			}
+		}
+		Service.ApplyOps(PlayerId, Ops, Results);
+	}
+
+	// Sequential player ids with a large stride, so they share low bits
+	uint64 GetPlayerId(const int32 Index)
+	{
+		return uint64(Index) << 20;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryServiceShardTest, "InventorySystem.Service.Shards",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryServiceShardTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	const UInventoryCatalog& Catalog = *Inventory->GetCatalog();
+
+	FInventoryService Service(Catalog, 12);
+	TestEqual(TEXT("Shard count rounds up to a power of two"), Service.NumShards(), 16);
+
+	// Every shard gets players, none gets a lot more than its share
+	TArray<int32> NumPlayersPerShard;
+	NumPlayersPerShard.AddZeroed(Service.NumShards());
+	for (int32 Index = 0; Index < NumPlayers; ++Index)
+	{
+		const int32 Shard = Service.GetShardIndex(GetPlayerId(Index));
+		if (!TestTrue(TEXT("Shard index in range"), Shard >= 0 && Shard < Service.NumShards()))
+			return false;
+
+		TestEqual(TEXT("Shard of a player is stable"), Service.GetShardIndex(GetPlayerId(Index)), Shard);
+		++NumPlayersPerShard[Shard];
+	}
+
+	const int32 ShareOfShard = NumPlayers / Service.NumShards();
+	for (const int32 NumPlayersOfShard : NumPlayersPerShard)
+	{
+		TestTrue(TEXT("Players spread over the shards"), NumPlayersOfShard > 0 && NumPlayersOfShard < 2 * ShareOfShard);
+	}
+
+	// Failed operations do not create players
+	const FInventoryItemId ItemId(1);
+	TestEqual(TEXT("Consume of an unknown player"), (int32)Service.ConsumeItem(1, ItemId), (int32)InventoryError::ENoItemsToConsume);
+	TestEqual(TEXT("Unequip of an unknown player"), (int32)Service.UnequipItem(1, FInventoryItemId(0)), (int32)InventoryError::ENotEquipped);
+	TestEqual(TEXT("Equip of a non equippable item"), (int32)Service.EquipItem(1, ItemId), (int32)InventoryError::ENotEquippable);
+	TestEqual(TEXT("Invalid item type"), (int32)Service.AddItem(1, FInventoryItemId(NumItemTypes)), (int32)InventoryError::EInvalidItemType);
+	TestEqual(TEXT("Players after failed operations"), Service.NumPlayers(), 0);
+
+	TestEqual(TEXT("First successful operation"), (int32)Service.AddItem(1, ItemId), (int32)InventoryError::ESuccess);
+	TestEqual(TEXT("Players after a successful operation"), Service.NumPlayers(), 1);
+	TestTrue(TEXT("Remove player"), Service.RemovePlayer(1));
+
+	// Players of different shards mutated in parallel, one thread per group
+	// of shards, end up as if they were mutated one after another
+	constexpr int32 NumThreads = 4;
+	TArray<TFuture<void>> Threads;
+	for (int32 Thread = 0; Thread < NumThreads; ++Thread)
+	{
+		Threads.Add(Async(EAsyncExecution::Thread, [&Service, Thread]()
+		{
+			for (int32 Index = 0; Index < NumPlayers; ++Index)
+			{
+				const uint64 PlayerId = GetPlayerId(Index);
+				if (Service.GetShardIndex(PlayerId) % NumThreads == Thread)
+					ApplyPlayerOps(Service, PlayerId);
+			}
+		}));
+	}
+
+	FInventoryService Reference(Catalog, 1);
+	for (int32 Index = 0; Index < NumPlayers; ++Index)
+	{
+		ApplyPlayerOps(Reference, GetPlayerId(Index));
+	}
+
+	for (TFuture<void>& Thread : Threads)
+	{
+		Thread.Wait();
+	}
+
+	TestEqual(TEXT("Number of players"), Service.NumPlayers(), Reference.NumPlayers());
+	for (int32 Index = 0; Index < NumPlayers; ++Index)
+	{
+		const uint64 PlayerId = GetPlayerId(Index);
+		for (int32 ItemIndex = 0; ItemIndex < NumItemTypes; ++ItemIndex)
+		{
+			const FInventoryItemId PlayerItemId(ItemIndex);
+			if (!TestEqual(TEXT("Quantity"), Service.GetItemQuantity(PlayerId, PlayerItemId), Reference.GetItemQuantity(PlayerId, PlayerItemId))
+				|| !TestEqual(TEXT("Equipped"), Service.IsItemEquipped(PlayerId, PlayerItemId), Reference.IsItemEquipped(PlayerId, PlayerItemId)))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryServicePerfTest, "InventorySystem.Perf.Service",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryServicePerfTest::RunTest(const FString& Parameters)
+{
+	// The same total work for every thread count, split evenly
+	constexpr int32 NumOps = 4000000;
+	constexpr int32 NumBenchmarkPlayers = 4096;
+
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	const UInventoryCatalog& Catalog = *Inventory->GetCatalog();
+
+	double SingleThreadOpsPerSecond = 0;
+	double FourThreadOpsPerSecond = 0;
+	for (const int32 NumThreads : { 1, 2, 4, 8, 16, 32, 64 })
+	{
+		FInventoryService Service(Catalog, 64);
+
+		// Each thread mutates its own players, like one trade or persistence 
+		// worker per group of players
+		const double StartTime = FPlatformTime::Seconds();
+		TArray<TFuture<void>> Threads;
+		for (int32 Thread = 0; Thread < NumThreads; ++Thread)
+		{
+			Threads.Add(Async(EAsyncExecution::Thread, [&Service, Thread, NumThreads]()
+			{
+				FRandomStream Random(Thread);
+				for (int32 Step = Thread; Step < NumOps; Step += NumThreads)
+				{
+					const uint64 PlayerId = GetPlayerId(Random.RandRange(0, NumBenchmarkPlayers / NumThreads - 1) * NumThreads + Thread);
+					const FInventoryOp Op = InventoryTests::MakeRandomOp(Random, NumItemTypes);
+					switch (Op.Type)
+					{
+					case InventoryOpType::EAdd:		Service.AddItem(PlayerId, Op.ItemId, Op.Quantity); break;
+					case InventoryOpType::EConsume:	Service.ConsumeItem(PlayerId, Op.ItemId, Op.Quantity); break;
+					case InventoryOpType::EEquip:	Service.EquipItem(PlayerId, Op.ItemId); break;
+					case InventoryOpType::EUnequip:	Service.UnequipItem(PlayerId, Op.ItemId); break;
+					}
+				}
+			}));
+		}
+
+		for (TFuture<void>& Thread : Threads)
+		{
+			Thread.Wait();
+		}
+		const double OpsPerSecond = NumOps / (FPlatformTime::Seconds() - StartTime);
+
+		if (NumThreads == 1)
+			SingleThreadOpsPerSecond = OpsPerSecond;
+		else if (NumThreads == 4)
+			FourThreadOpsPerSecond = OpsPerSecond;
+
+		AddInfo(FString::Printf(TEXT("%d threads: %.2f M ops/s, %.2fx one thread"), NumThreads, OpsPerSecond * 1e-6, OpsPerSecond / SingleThreadOpsPerSecond));
+		TestTrue(TEXT("Players were created"), Service.NumPlayers() > 0);
+	}
+
+	// Throughput scales with cores where there are cores to scale to
+	if (FPlatformMisc::NumberOfCores() >= 4)
+		TestTrue(TEXT("Four threads are faster than one"), FourThreadOpsPerSecond > SingleThreadOpsPerSecond);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include <atomic>
+
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Async.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 40;
+
+	// The per item state a snapshot should hold
+	struct FExpectedState
+	{
+		TArray<int32> Quantities;
+		TArray<bool> Equipped;
+	};
+
+	FExpectedState GetState(const UInventory& Inventory)
+	{
+		FExpectedState State;
+		for (int32 Index = 0; Index < NumItemTypes; ++Index)
+		{
+			const FInventoryItemId ItemId(Index);
+			State.Quantities.Add(Inventory.GetItemQuantity(ItemId));
+			State.Equipped.Add(Inventory.IsItemEquipped(ItemId));
+		}
+		return State;
+	}
+
+	bool HasState(const FInventorySnapshot& Snapshot, const FExpectedState& State)
+	{
+		for (int32 Index = 0; Index < NumItemTypes; ++Index)
+		{
+			const FInventoryItemId ItemId(Index);
+			if (Snapshot.GetItemQuantity(ItemId) != State.Quantities[Index] || Snapshot.IsItemEquipped(ItemId) != State.Equipped[Index])
+				return false;
+		}
+		return true;
+	}
+
+	void ApplyRandomOps(UInventory& Inventory, FRandomStream& Random, const int32 NumOps)
+	{
+		TArray<FInventoryOp> Ops;
+		for (int32 Step = 0; Step < NumOps; ++Step)
+		{
+			Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+		}
+
+		TArray<InventoryError> Results;
+		Inventory.ApplyOps(Ops, Results);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySnapshotConsistencyTest, "InventorySystem.Snapshot.Consistency",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySnapshotConsistencyTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+
+	FRandomStream Random(17);
+	ApplyRandomOps(*Inventory, Random, 100);
+	TestFalse(TEXT("Snapshot before snapshots were enabled"), Inventory->GetSnapshot().IsValid());
+
+	Inventory->EnableSnapshots();
+	const FInventorySnapshotPtr Held = Inventory->GetSnapshot();
+	if (!TestTrue(TEXT("Snapshot after snapshots were enabled"), Held.IsValid()))
+		return false;
+
+	const int64 HeldGeneration = Inventory->GetGeneration();
+	const FExpectedState HeldState = GetState(*Inventory);
+	TestEqual(TEXT("Snapshot generation"), Held->Generation, HeldGeneration);
+	TestTrue(TEXT("Snapshot equals the inventory"), HasState(*Held, HeldState));
+
+	// Mutating the inventory and publishing again leaves the held snapshot as it was
+	FInventorySnapshotPtr Latest = Held;
+	for (int32 Round = 0; Round < 20; ++Round)
+	{
+		ApplyRandomOps(*Inventory, Random, 50);
+		TestTrue(TEXT("Changes are not visible before they are published"), Inventory->GetSnapshot() == Latest);
+
+		Inventory->EnableSnapshots();
+		Latest = Inventory->GetSnapshot();
+		TestEqual(TEXT("Latest snapshot generation"), Latest->Generation, Inventory->GetGeneration());
+		TestTrue(TEXT("Latest snapshot equals the inventory"), HasState(*Latest, GetState(*Inventory)));
+	}
+
+	TestEqual(TEXT("Held snapshot generation"), Held->Generation, HeldGeneration);
+	TestTrue(TEXT("Held snapshot is unchanged"), HasState(*Held, HeldState));
+
+	// Publishing without a change keeps the published snapshot
+	const FInventorySnapshotPtr Unchanged = Inventory->GetSnapshot();
+	Inventory->EnableSnapshots();
+	TestTrue(TEXT("Unchanged inventory keeps its snapshot"), Inventory->GetSnapshot() == Unchanged);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySnapshotReaderThreadTest, "InventorySystem.Snapshot.ReaderThread",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySnapshotReaderThreadTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	Inventory->EnableSnapshots();
+
+	// The state of every published generation, recorded before it is published
+	FCriticalSection PublishedLock;
+	TMap<int64, FExpectedState> PublishedStates;
+	PublishedStates.Add(Inventory->GetGeneration(), GetState(*Inventory));
+
+	std::atomic<bool> bDone{ false };
+	std::atomic<int32> NumRead{ 0 };
+	std::atomic<int32> NumInconsistent{ 0 };
+
+	TFuture<void> Reader = Async(EAsyncExecution::Thread, [&]()
+	{
+		while (!bDone.load())
+		{
+			const FInventorySnapshotPtr Snapshot = Inventory->GetSnapshot();
+			if (!Snapshot.IsValid())
+			{
+				NumInconsistent.fetch_add(1);
+				continue;
+			}
+
+			FScopeLock Lock(&PublishedLock);
+			const FExpectedState* State = PublishedStates.Find(Snapshot->Generation);
+			if (!State || !HasState(*Snapshot, *State))
+				NumInconsistent.fetch_add(1);
+
+			NumRead.fetch_add(1);
+		}
+	});
+
+	FRandomStream Random(18);
+	for (int32 Round = 0; Round < 2000; ++Round)
+	{
+		ApplyRandomOps(*Inventory, Random, 10);
+		{
+			FScopeLock Lock(&PublishedLock);
+			PublishedStates.Add(Inventory->GetGeneration(), GetState(*Inventory));
+		}
+		Inventory->EnableSnapshots();
+	}
+
+	bDone.store(true);
+	Reader.Wait();
+
+	TestTrue(TEXT("Reader read snapshots"), NumRead.load() > 0);
+	TestEqual(TEXT("Inconsistent snapshots read"), NumInconsistent.load(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySnapshotPerfTest, "InventorySystem.Perf.Snapshot",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventorySnapshotPerfTest::RunTest(const FString& Parameters)
+{
+	constexpr double MeasureSeconds = 0.5;
+
+	for (const int32 NumReaders : { 1, 2, 4, 8, 16 })
+	{
+		UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+		Inventory->EnableSnapshots();
+
+		std::atomic<bool> bDone{ false };
+		std::atomic<int64> NumRead{ 0 };
+		std::atomic<int32> NumOutOfOrder{ 0 };
+		std::atomic<int64> TotalQuantity{ 0 };
+
+		// Each reader takes the latest snapshot and reads every item of it, 
+		// like an AI query would
+		TArray<TFuture<void>> Readers;
+		for (int32 Reader = 0; Reader < NumReaders; ++Reader)
+		{
+			Readers.Add(Async(EAsyncExecution::Thread, [&]()
+			{
+				int64 NumReaderRead = 0;
+				int64 LastGeneration = 0;
+				int64 ReaderTotalQuantity = 0;
+				while (!bDone.load(std::memory_order_relaxed))
+				{
+					const FInventorySnapshotPtr Snapshot = Inventory->GetSnapshot();
+					if (Snapshot->Generation < LastGeneration)
+						NumOutOfOrder.fetch_add(1);
+					LastGeneration = Snapshot->Generation;
+
+					for (int32 Index = 0; Index < NumItemTypes; ++Index)
+					{
+						ReaderTotalQuantity += Snapshot->GetItemQuantity(FInventoryItemId(Index));
+					}
+					++NumReaderRead;
+				}
+				NumRead.fetch_add(NumReaderRead);
+				TotalQuantity.fetch_add(ReaderTotalQuantity);
+			}));
+		}
+
+		// The writer mutates and publishes as fast as it can, as if every 
+		// frame changed the inventory
+		FRandomStream Random(17);
+		int64 NumPublished = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		double Seconds = 0;
+		while (Seconds < MeasureSeconds)
+		{
+			ApplyRandomOps(*Inventory, Random, 10);
+			Inventory->EnableSnapshots();
+			++NumPublished;
+			Seconds = FPlatformTime::Seconds() - StartTime;
+		}
+
+		bDone.store(true);
+		for (TFuture<void>& Reader : Readers)
+		{
+			Reader.Wait();
+		}
+
+		AddInfo(FString::Printf(TEXT("%d readers: %.2f M reads/s in total, %.2f M per reader, writer %.2f M publishes/s"),
+			NumReaders, NumRead.load() / Seconds * 1e-6, NumRead.load() / Seconds * 1e-6 / NumReaders, NumPublished / Seconds * 1e-6));
+
+		TestTrue(TEXT("Readers read snapshots"), NumRead.load() > 0 && TotalQuantity.load() >= 0);
+		TestEqual(TEXT("Snapshots read out of order"), NumOutOfOrder.load(), 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Algo/Sort.h"
+#include "InventorySort.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 300;
+
+	// Names in an order unrelated to item ids and differing in case, so name
+	// order, folding and the item id tie break are all visible
+	FString GetShuffledName(const int32 I)
+	{
+		static const TCHAR* const Prefixes[] = { TEXT("apple"), TEXT("Axe"), TEXT("BOW"), TEXT("arrow"), TEXT("bread") };
+		return FString::Printf(TEXT("%s%d"), Prefixes[I % 5], (I * 37) % NumItemTypes);
+	}
+
+	int32 GetCategory(const FInventoryItemDefinition& Definition)
+	{
+		return Definition.IsEquippable ? 0 : Definition.IsConsumable ? 1 : 2;
+	}
+
+	int32 GetBoost(const FInventoryItemDefinition& Definition, const FString& Stat)
+	{
+		const FBoostAndDuration* Boost = Definition.StatsBoostsAndDurations.Find(Stat);
+		return Boost ? Boost->Boost : 0;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryRadixSortTest, "InventorySystem.Sort.RadixSort",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryRadixSortTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(24);
+	TArray<FInventorySortEntry> Entries;
+	TArray<FInventorySortEntry> Expected;
+	TArray<FInventorySortEntry> Scratch;
+
+	for (const int32 NumKeyBits : { 1, 7, 8, 13, 32, 40, 64 })
+	{
+		const uint64 KeyMask = NumKeyBits >= 64 ? ~uint64(0) : (uint64(1) << NumKeyBits) - 1;
+
+		Entries.Reset();
+		for (int32 Index = 0; Index < 1000; ++Index)
+		{
+			// A third of the keys only use the lowest byte, so equal keys occur
+			const uint64 Key = (uint64(Random.GetUnsignedInt()) << 32 | Random.GetUnsignedInt()) & (Index % 3 == 0 ? 0xff : KeyMask);
+			Entries.Add({ Key & KeyMask, Index });
+		}
+
+		Expected = Entries;
+		Algo::StableSort(Expected, [](const FInventorySortEntry& A, const FInventorySortEntry& B) { return A.Key < B.Key; });
+
+		FInventoryRadixSort::Sort(Entries, Scratch, NumKeyBits);
+
+		bool bSameOrder = true;
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			bSameOrder &= Entries[Index].Key == Expected[Index].Key && Entries[Index].Value == Expected[Index].Value;
+		}
+		TestTrue(FString::Printf(TEXT("Stable order of %d bit keys"), NumKeyBits), bSameOrder);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySortOrderTest, "InventorySystem.Sort.Orders",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventorySortOrderTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = NewObject<UInventory>();
+	for (const TCHAR* StatName : InventoryTests::StatNames)
+	{
+		Inventory->AddPossibleStat(StatName);
+	}
+
+	TArray<FInventoryItemDefinition> Definitions;
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		FInventoryItemDefinition& Definition = Definitions.Add_GetRef(InventoryTests::MakeItemDefinition(I));
+		Definition.Name = GetShuffledName(I);
+
+		// Wide boosts take more than one byte of key
+		for (TPair<FString, FBoostAndDuration>& Stat : Definition.StatsBoostsAndDurations)
+		{
+			Stat.Value.Boost *= 1 + I % 11 * 100;
+		}
+
+		Inventory->AddInventoryItemType(Definition.Name, Definition.FlavorText, Definition.Thumbnail, Definition.FullImage,
+			Definition.StatsBoostsAndDurations, Definition.MaximumQuantity, Definition.IsConsumable, Definition.IsEquippable);
+	}
+
+	FRandomStream Random(25);
+	for (int32 I = 0; I < NumItemTypes; ++I)
+	{
+		if (Random.RandRange(0, 3) > 0)
+			Inventory->AddItem(FInventoryItemId(I), Random.RandRange(1, FMath::Max(Definitions[I].MaximumQuantity, 1)));
+	}
+
+	const FString Stats[] = { TEXT(""), TEXT("Health"), TEXT("Mana"), TEXT("Speed"), TEXT("NotAStat") };
+	for (const FString& Stat : Stats)
+	{
+		for (int32 Flags = 0; Flags < 32; ++Flags)
+		{
+			FInventorySortOrder Order;
+			Order.Stat = Stat;
+			Order.bByCategory = (Flags & 1) != 0;
+			Order.bStatDescending = (Flags & 2) != 0;
+			Order.bByName = (Flags & 4) != 0;
+			Order.bByQuantity = (Flags & 8) != 0;
+			Order.bQuantityDescending = (Flags & 16) != 0;
+
+			TArray<FInventoryItemId> Sorted = Inventory->SortItems(Order);
+			TArray<FInventoryItemId> Expected = Sorted;
+
+			Algo::Sort(Expected, [&](const FInventoryItemId A, const FInventoryItemId B)
+			{
+				const FInventoryItemDefinition& DefinitionA = Definitions[A.Index];
+				const FInventoryItemDefinition& DefinitionB = Definitions[B.Index];
+
+				if (Order.bByCategory && GetCategory(DefinitionA) != GetCategory(DefinitionB))
+					return GetCategory(DefinitionA) < GetCategory(DefinitionB);
+
+				const int32 BoostA = GetBoost(DefinitionA, Order.Stat);
+				const int32 BoostB = GetBoost(DefinitionB, Order.Stat);
+				if (BoostA != BoostB)
+					return Order.bStatDescending ? BoostA > BoostB : BoostA < BoostB;
+
+				if (Order.bByName)
+				{
+					const int32 Compared = DefinitionA.Name.ToLower().Compare(DefinitionB.Name.ToLower(), ESearchCase::CaseSensitive);
+					if (Compared != 0)
+						return Compared < 0;
+				}
+
+				const int32 QuantityA = Inventory->GetItemQuantity(A);
+				const int32 QuantityB = Inventory->GetItemQuantity(B);
+				if (Order.bByQuantity && QuantityA != QuantityB)
+					return Order.bQuantityDescending ? QuantityA > QuantityB : QuantityA < QuantityB;
+
+				return A.Index < B.Index;
+			});
+
+			if (!TestTrue(FString::Printf(TEXT("Order of stat '%s' with flags %d"), *Stat, Flags), Sorted == Expected))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySortPerfTest, "InventorySystem.Perf.Sort",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventorySortPerfTest::RunTest(const FString& Parameters)
+{
+	// Every measurement sorts about this many entries, so small arrays are
+	// timed over many repeats
+	constexpr int32 NumEntriesPerMeasurement = 4000000;
+
+	// The sort engine alone: packed keys as wide as category, stat, name rank
+	// and quantity take
+	FRandomStream Random(24);
+	TArray<FInventorySortEntry> Original;
+	TArray<FInventorySortEntry> Entries;
+	TArray<FInventorySortEntry> Scratch;
+	for (const int32 NumEntries : { 1000, 10000, 100000, 1000000 })
+	{
+		Original.Reset();
+		for (int32 Index = 0; Index < NumEntries; ++Index)
+		{
+			Original.Add({ (uint64(Random.GetUnsignedInt()) << 32 | Random.GetUnsignedInt()) & ((uint64(1) << 48) - 1), Index });
+		}
+
+		const int32 NumRepeats = FMath::Max(NumEntriesPerMeasurement / NumEntries, 1);
+		auto Measure = [&](auto&& SortEntries)
+		{
+			double Seconds = 0;
+			for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+			{
+				Entries = Original;
+				const double StartTime = FPlatformTime::Seconds();
+				SortEntries();
+				Seconds += FPlatformTime::Seconds() - StartTime;
+			}
+			return Seconds / NumRepeats;
+		};
+
+		const double ComparisonSeconds = Measure([&Entries]()
+		{
+			Algo::StableSort(Entries, [](const FInventorySortEntry& A, const FInventorySortEntry& B) { return A.Key < B.Key; });
+		});
+		const TArray<FInventorySortEntry> Expected = Entries;
+
+		const double RadixSeconds = Measure([&Entries, &Scratch]()
+		{
+			FInventoryRadixSort::Sort(Entries, Scratch, 48);
+		});
+
+		bool bSameOrder = true;
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			bSameOrder &= Entries[Index].Key == Expected[Index].Key && Entries[Index].Value == Expected[Index].Value;
+		}
+		TestTrue(TEXT("Radix sort order"), bSameOrder);
+
+		AddInfo(FString::Printf(TEXT("%d entries: comparison sort %.1f us, radix sort %.1f us, %.2fx"),
+			NumEntries, ComparisonSeconds * 1e6, RadixSeconds * 1e6, ComparisonSeconds / RadixSeconds));
+		if (NumEntries >= 10000)
+			TestTrue(TEXT("Radix sort is faster than the comparison sort"), RadixSeconds < ComparisonSeconds);
+	}
+
+	// The sort button: a comparison sort of an inventory copy by names and 
+	// stat lookups against SortItems
+	FInventorySortOrder Order;
+	Order.bByCategory = true;
+	Order.Stat = TEXT("Health");
+	Order.bStatDescending = true;
+	Order.bByName = true;
+
+	for (const int32 NumOwned : { 1000, 10000, 100000 })
+	{
+		UInventory* Inventory = InventoryTests::MakeInventory(NumOwned * 7 / 6 + 1);
+		for (int32 I = 0; I < NumOwned * 7 / 6 + 1; ++I)
+		{
+			Inventory->AddItem(FInventoryItemId(I));
+		}
+
+		const int32 NumRepeats = FMath::Max(NumEntriesPerMeasurement / 10 / NumOwned, 1);
+
+		TArray<FInventoryItem> Items;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			Items = Inventory->GetInventory();
+			Items.RemoveAll([](const FInventoryItem& Item) { return Item.Quantity == 0; });
+			Algo::Sort(Items, [](const FInventoryItem& A, const FInventoryItem& B)
+			{
+				const int32 CategoryA = A.IsEquippable ? 0 : A.IsConsumable ? 1 : 2;
+				const int32 CategoryB = B.IsEquippable ? 0 : B.IsConsumable ? 1 : 2;
+				if (CategoryA != CategoryB)
+					return CategoryA < CategoryB;
+
+				const FBoostAndDuration* BoostA = A.StatsBoostsAndDurations.Find(TEXT("Health"));
+				const FBoostAndDuration* BoostB = B.StatsBoostsAndDurations.Find(TEXT("Health"));
+				const int32 StatA = BoostA ? BoostA->Boost : 0;
+				const int32 StatB = BoostB ? BoostB->Boost : 0;
+				if (StatA != StatB)
+					return StatA > StatB;
+
+				return A.Name.Compare(B.Name, ESearchCase::IgnoreCase) < 0;
+			});
+		}
+		const double ComparisonSeconds = (FPlatformTime::Seconds() - StartTime) / NumRepeats;
+
+		TArray<FInventoryItemId> Sorted;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			Sorted = Inventory->SortItems(Order);
+		}
+		const double RadixSeconds = (FPlatformTime::Seconds() - StartTime) / NumRepeats;
+
+		bool bSameOrder = Sorted.Num() == Items.Num();
+		for (int32 Index = 0; bSameOrder && Index < Sorted.Num(); ++Index)
+		{
+			bSameOrder = Inventory->FindItemId(Items[Index].Name) == Sorted[Index];
+		}
+		TestTrue(TEXT("SortItems order"), bSameOrder);
+
+		AddInfo(FString::Printf(TEXT("%d owned items: comparison sort of a copy %.1f us, SortItems %.1f us, %.2fx"),
+			Sorted.Num(), ComparisonSeconds * 1e6, RadixSeconds * 1e6, ComparisonSeconds / RadixSeconds));
+		TestTrue(TEXT("SortItems is faster than sorting a copy"), RadixSeconds < ComparisonSeconds);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/WorldSettings.h"
+#include "Inventory.h"
+#include "InventoryWorldSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryTests
+{
+	// The stats every test inventory has
+	static const TCHAR* const StatNames[] = { TEXT("Health"), TEXT("Mana"), TEXT("Speed") };
+
+	// The name of test item type I
+	inline FString GetItemName(const int32 I)
+	{
+		return FString::Printf(TEXT("Item%03d"), I);
+	}
+
+	// The definition of test item type I. Maximum quantities, flags and
+	// boosts cycle with different periods so every combination occurs.
+	inline FInventoryItemDefinition MakeItemDefinition(const int32 I)
+	{
+		FInventoryItemDefinition Definition;
+		Definition.Name = GetItemName(I);
+		Definition.FlavorText = FString::Printf(TEXT("Flavor of item %d"), I);
+		Definition.MaximumQuantity = I % 7 == 6 ? 0 : 1 + I % 7 * 3;
+		Definition.IsConsumable = I % 3 != 0;
+		Definition.IsEquippable = I % 2 == 0;
+
+		if (I % 4 != 3)
+		{
+			FBoostAndDuration Boost;
+			Boost.Boost = I % 5 - 2;
+			Boost.Duration = I % 4;
+			Definition.StatsBoostsAndDurations.Add(StatNames[I % 3], Boost);
+		}
+
+		return Definition;
+	}
+
+	// Adds the test stats and registers test item types 0 to NumItemTypes - 1
+	inline void AddTestItemTypes(UInventory& Inventory, const int32 NumItemTypes)
+	{
+		for (const TCHAR* StatName : StatNames)
+		{
+			Inventory.AddPossibleStat(StatName);
+		}
+
+		for (int32 I = 0; I < NumItemTypes; ++I)
+		{
+			const FInventoryItemDefinition Definition = MakeItemDefinition(I);
+			Inventory.AddInventoryItemType(Definition.Name, Definition.FlavorText, Definition.Thumbnail, Definition.FullImage,
+				Definition.StatsBoostsAndDurations, Definition.MaximumQuantity, Definition.IsConsumable, Definition.IsEquippable);
+		}
+	}
+
+	/** Creates an inventory outside of any world with test item types 0 to
+	 * NumItemTypes - 1 registered.
+	 * @param Catalog - The catalog to register the item types in, a new one
+	 * of the inventory's own if null.
+	 */
+	inline UInventory* MakeInventory(const int32 NumItemTypes, UInventoryCatalog* Catalog = nullptr)
+	{
+		UInventory* Inventory = NewObject<UInventory>();
+		if (Catalog)
+			Inventory->SetCatalog(Catalog);
+
+		AddTestItemTypes(*Inventory, NumItemTypes);
+		return Inventory;
+	}
+
+	/** A game world that has begun play, for inventories that need their 
+	 * world subsystem. Nothing ticks on its own, tests tick the subsystem.
+	 * Destroyed with everything spawned in it when it goes out of scope.
+	 */
+	struct FTestWorld
+	{
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->GetWorldSettings()->NotifyBeginPlay();
+		}
+
+		~FTestWorld()
+		{
+			for (AActor* Actor : Actors)
+			{
+				if (IsValid(Actor))
+					Actor->Destroy();
+			}
+
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		FTestWorld(const FTestWorld&) = delete;
+		FTestWorld& operator=(const FTestWorld&) = delete;
+
+		// Spawns an actor with an inventory, which begins play right away
+		UInventory* SpawnInventory()
+		{
+			AActor* Actor = Actors.Add_GetRef(World->SpawnActor<AActor>());
+			UInventory* Inventory = NewObject<UInventory>(Actor);
+			Inventory->RegisterComponent();
+			return Inventory;
+		}
+
+		UInventoryWorldSubsystem* GetSubsystem() const { return World->GetSubsystem<UInventoryWorldSubsystem>(); }
+
+		UWorld* World = nullptr;
+		TArray<AActor*> Actors;
+	};
+
+	// Do two inventories hold the same quantities and equip states of test
+	// item types 0 to NumItemTypes - 1?
+	inline bool HaveSameState(const UInventory& A, const UInventory& B, const int32 NumItemTypes)
+	{
+		for (int32 Index = 0; Index < NumItemTypes; ++Index)
+		{
+			const FInventoryItemId ItemId(Index);
+			if (A.GetItemQuantity(ItemId) != B.GetItemQuantity(ItemId) || A.IsItemEquipped(ItemId) != B.IsItemEquipped(ItemId))
+				return false;
+		}
+		return true;
+	}
+
+	// A random operation on one of test item types 0 to NumItemTypes - 1
+	inline FInventoryOp MakeRandomOp(FRandomStream& Random, const int32 NumItemTypes)
+	{
+		FInventoryOp Op;
+		Op.Type = InventoryOpType(Random.RandRange(0, 3));
+		Op.ItemId = FInventoryItemId(Random.RandRange(0, NumItemTypes - 1));
+		Op.Quantity = Random.RandRange(1, 6);
+		return Op;
+	}
+}
+
+#endif
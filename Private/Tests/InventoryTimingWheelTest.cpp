@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTimingWheel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTimingWheelExpiryTest, "InventorySystem.TimingWheel.Expiry",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryTimingWheelExpiryTest::RunTest(const FString& Parameters)
+{
+	FInventoryTimingWheel Wheel;
+	FRandomStream Random(9);
+
+	// Due ticks spread over every level, so timers cascade down one or more
+	// levels before they fire. ItemIndex holds the timer number.
+	constexpr int32 NumTimers = 2000;
+	constexpr uint64 LastDueTick = 300000;
+	TArray<uint64> DueTicks;
+	TArray<int32> NumFired;
+	for (int32 Timer = 0; Timer < NumTimers; ++Timer)
+	{
+		const int32 Level = Random.RandRange(0, 3);
+		const uint64 DueTick = FMath::Min<uint64>(1 + Random.RandRange(0, (64 << (6 * Level)) - 1), LastDueTick);
+
+		FInventoryTimedBoost Boost;
+		Boost.ItemIndex = Timer;
+		Wheel.Schedule(Boost, DueTick);
+		DueTicks.Add(DueTick);
+		NumFired.Add(0);
+	}
+	TestEqual(TEXT("Scheduled timers"), Wheel.Num(), NumTimers);
+
+	// Advance in uneven steps, every timer fires in the step covering its
+	// due tick and is then released
+	TArray<int32> Fired;
+	while (Wheel.GetCurrentTick() < LastDueTick)
+	{
+		const uint64 FromTick = Wheel.GetCurrentTick();
+		const uint64 ToTick = FMath::Min<uint64>(FromTick + Random.RandRange(1, 700), LastDueTick);
+
+		Fired.Reset();
+		Wheel.Advance(ToTick, Fired);
+		TestEqual(TEXT("Current tick"), int64(Wheel.GetCurrentTick()), int64(ToTick));
+
+		for (const int32 Handle : Fired)
+		{
+			const int32 Timer = Wheel.Get(Handle).ItemIndex;
+			++NumFired[Timer];
+			if (!TestTrue(FString::Printf(TEXT("Timer due at %llu fired between %llu and %llu"), DueTicks[Timer], FromTick, ToTick),
+				DueTicks[Timer] > FromTick && DueTicks[Timer] <= ToTick))
+				return false;
+
+			Wheel.Release(Handle);
+		}
+	}
+
+	for (const int32 Count : NumFired)
+	{
+		TestEqual(TEXT("Every timer fired once"), Count, 1);
+	}
+	TestEqual(TEXT("Timers left"), Wheel.Num(), 0);
+
+	// A timer due before the current tick fires on the next one
+	FInventoryTimedBoost Late;
+	Late.ItemIndex = 7;
+	Wheel.Schedule(Late, 5);
+	Fired.Reset();
+	Wheel.Advance(LastDueTick + 1, Fired);
+	TestTrue(TEXT("Late timer fires on the next tick"), Fired.Num() == 1 && Wheel.Get(Fired[0]).ItemIndex == 7);
+	Wheel.Release(Fired[0]);
+
+	// A timer further out than the wheel spans waits in the top level until
+	// it is in range, and released handles are reused
+	constexpr uint64 FarDelta = (uint64(1) << 24) + 1000;
+	const uint64 FarDueTick = Wheel.GetCurrentTick() + FarDelta;
+	const int32 FarHandle = Wheel.Schedule(Late, FarDueTick);
+	TestEqual(TEXT("Released handle reused"), FarHandle, Fired[0]);
+
+	Fired.Reset();
+	Wheel.Advance(FarDueTick - 1, Fired);
+	TestEqual(TEXT("Far timer before its due tick"), Fired.Num(), 0);
+	Wheel.Advance(FarDueTick, Fired);
+	TestTrue(TEXT("Far timer on its due tick"), Fired.Num() == 1 && Fired[0] == FarHandle);
+	Wheel.Release(FarHandle);
+
+	// An empty wheel skips ahead at once
+	Wheel.Advance(Wheel.GetCurrentTick() + 1000000000, Fired);
+	TestEqual(TEXT("Empty wheel skips ahead"), Wheel.Num(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTimingWheelPulseTest, "InventorySystem.TimingWheel.Pulses",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryTimingWheelPulseTest::RunTest(const FString& Parameters)
+{
+	FInventoryTimingWheel Wheel;
+
+	// Periodic boosts are rescheduled on every pulse until they end, like
+	// the world subsystem does. Periods and durations that are not multiples
+	// of each other end with a short last interval.
+	struct FPulseCase
+	{
+		uint64 PeriodTicks;
+		uint64 EndTick;
+	};
+	const FPulseCase Cases[] = { { 1, 10 }, { 7, 70 }, { 60, 200 }, { 64, 4096 }, { 1000, 300000 } };
+
+	constexpr int32 NumCases = UE_ARRAY_COUNT(Cases);
+
+	TArray<int32> NumPulses;
+	for (int32 Case = 0; Case < NumCases; ++Case)
+	{
+		FInventoryTimedBoost Boost;
+		Boost.ItemIndex = Case;
+		Boost.PeriodTicks = Cases[Case].PeriodTicks;
+		Boost.NextPulseTick = Boost.PeriodTicks;
+		Boost.EndTick = Cases[Case].EndTick;
+		Wheel.Schedule(Boost, FMath::Min(Boost.NextPulseTick, Boost.EndTick));
+		NumPulses.Add(0);
+	}
+
+	// One tick at a time, so the current tick is the tick a timer fired at
+	TArray<int32> Fired;
+	while (Wheel.Num() > 0)
+	{
+		Fired.Reset();
+		Wheel.Advance(Wheel.GetCurrentTick() + 1, Fired);
+
+		for (const int32 Handle : Fired)
+		{
+			FInventoryTimedBoost& Boost = Wheel.Get(Handle);
+			const uint64 Now = Wheel.GetCurrentTick();
+			if (Now >= Boost.NextPulseTick)
+			{
+				TestEqual(TEXT("Pulse on time"), int64(Now), int64(Boost.NextPulseTick));
+				++NumPulses[Boost.ItemIndex];
+				Boost.NextPulseTick += Boost.PeriodTicks;
+			}
+
+			if (Now >= Boost.EndTick)
+			{
+				TestEqual(TEXT("Expired on time"), int64(Now), int64(Boost.EndTick));
+				Wheel.Release(Handle);
+			}
+			else
+			{
+				Wheel.Reschedule(Handle, FMath::Min(Boost.NextPulseTick, Boost.EndTick));
+			}
+		}
+	}
+
+	for (int32 Case = 0; Case < NumCases; ++Case)
+	{
+		TestEqual(FString::Printf(TEXT("Pulses of period %llu until %llu"), Cases[Case].PeriodTicks, Cases[Case].EndTick),
+			NumPulses[Case], int32(Cases[Case].EndTick / Cases[Case].PeriodTicks));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 10;
+
+	// Test item types with the properties the cases need, see
+	// InventoryTests::MakeItemDefinition
+	const FInventoryItemId Sword(0);		// Maximum 1, equippable, not consumable
+	const FInventoryItemId Potion(1);		// Maximum 4, consumable, not equippable
+	const FInventoryItemId Ring(2);			// Maximum 7, consumable and equippable
+	const FInventoryItemId Stone(3);		// Maximum 10, neither
+
+	FInventoryOp MakeOp(const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity = 1)
+	{
+		FInventoryOp Op;
+		Op.Type = Type;
+		Op.ItemId = ItemId;
+		Op.Quantity = Quantity;
+		return Op;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryTransactionCommitTest, "InventorySystem.Transaction.CommitAndRollback",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryTransactionCommitTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+	UInventory* Unchanged = InventoryTests::MakeInventory(NumItemTypes, Inventory->GetCatalog());
+	for (UInventory* Each : { Inventory, Unchanged })
+	{
+		Each->AddItem(Potion, 2);
+		Each->AddItem(Ring, 1);
+		Each->EquipItem(Ring);
+	}
+
+	// Staged changes touch nothing until they are committed
+	{
+		FInventoryTransaction Transaction = Inventory->BeginTransaction();
+		TestEqual(TEXT("Stage add"), (int32)Transaction.AddItem(Stone, 5), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Stage consume"), (int32)Transaction.ConsumeItem(Potion, 2), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Stage unequip"), (int32)Transaction.UnequipItem(Ring), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Stage equip"), (int32)Transaction.EquipItem(Sword), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Stage equip twice"), (int32)Transaction.EquipItem(Sword), (int32)InventoryError::EAlreadyEquipped);
+		TestEqual(TEXT("Stage unequip twice"), (int32)Transaction.UnequipItem(Ring), (int32)InventoryError::ENotEquipped);
+		TestEqual(TEXT("Stage an unknown item"), (int32)Transaction.AddItem(FInventoryItemId(NumItemTypes)), (int32)InventoryError::EInvalidItemType);
+		TestEqual(TEXT("Touched items"), Transaction.NumTouchedItems(), 4);
+		TestTrue(TEXT("Nothing applied before the commit"), InventoryTests::HaveSameState(*Inventory, *Unchanged, NumItemTypes));
+
+		TestEqual(TEXT("Commit"), (int32)Transaction.Commit(), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Committed add"), Inventory->GetItemQuantity(Stone), 5);
+		TestEqual(TEXT("Committed consume"), Inventory->GetItemQuantity(Potion), 0);
+		TestFalse(TEXT("Committed unequip"), Inventory->IsItemEquipped(Ring));
+		TestTrue(TEXT("Committed equip"), Inventory->IsItemEquipped(Sword));
+		TestEqual(TEXT("Transaction empty after the commit"), Transaction.NumTouchedItems(), 0);
+		TestTrue(TEXT("Equipped stat totals follow the commit"), Inventory->ValidateEquippedStatTotals());
+	}
+
+	Unchanged->ApplyOps({ MakeOp(InventoryOpType::EAdd, Stone, 5), MakeOp(InventoryOpType::EConsume, Potion, 2),
+		MakeOp(InventoryOpType::EUnequip, Ring), MakeOp(InventoryOpType::EEquip, Sword) });
+	TestTrue(TEXT("Committed state"), InventoryTests::HaveSameState(*Inventory, *Unchanged, NumItemTypes));
+
+	// Rolled back and abandoned transactions change nothing
+	{
+		FInventoryTransaction Transaction = Inventory->BeginTransaction();
+		Transaction.AddItem(Potion, 3);
+		Transaction.UnequipItem(Sword);
+		Transaction.Rollback();
+		TestEqual(TEXT("Touched items after a rollback"), Transaction.NumTouchedItems(), 0);
+		TestEqual(TEXT("Commit after a rollback"), (int32)Transaction.Commit(), (int32)InventoryError::ESuccess);
+	}
+	{
+		FInventoryTransaction Transaction = Inventory->BeginTransaction();
+		Transaction.AddItem(Potion, 3);
+		Transaction.UnequipItem(Sword);
+	}
+	TestTrue(TEXT("Rolled back state"), InventoryTests::HaveSameState(*Inventory, *Unchanged, NumItemTypes));
+
+	// Any failing item fails the whole transaction and reports the item
+	struct FFailureCase
+	{
+		const TCHAR* What;
+		FInventoryOp Op;
+		InventoryError Error;
+	};
+	const FFailureCase Cases[] = {
+		{ TEXT("Above the maximum"), MakeOp(InventoryOpType::EAdd, Stone, 6), InventoryError::EMaxQuantityExceeded },
+		{ TEXT("More than available"), MakeOp(InventoryOpType::EConsume, Ring, 2), InventoryError::ENoItemsToConsume },
+		{ TEXT("Not consumable"), MakeOp(InventoryOpType::EConsume, Stone), InventoryError::ENotConsumable },
+		{ TEXT("Not equippable"), MakeOp(InventoryOpType::EEquip, Stone), InventoryError::ENotEquippable },
+	};
+	for (const FFailureCase& Case : Cases)
+	{
+		FInventoryTransaction Transaction = Inventory->BeginTransaction();
+		Transaction.AddItem(Potion, 4);
+		Transaction.EquipItem(Ring);
+		switch (Case.Op.Type)
+		{
+		case InventoryOpType::EAdd:		Transaction.AddItem(Case.Op.ItemId, Case.Op.Quantity); break;
+		case InventoryOpType::EConsume:	Transaction.ConsumeItem(Case.Op.ItemId, Case.Op.Quantity); break;
+		case InventoryOpType::EEquip:	Transaction.EquipItem(Case.Op.ItemId); break;
+		case InventoryOpType::EUnequip:	Transaction.UnequipItem(Case.Op.ItemId); break;
+		}
+
+		FInventoryItemId FailedItem;
+		TestEqual(Case.What, (int32)Transaction.Commit(&FailedItem), (int32)Case.Error);
+		TestEqual(FString::Printf(TEXT("%s fails on its item"), Case.What), FailedItem.Index, Case.Op.ItemId.Index);
+		TestTrue(FString::Printf(TEXT("%s applies nothing"), Case.What), InventoryTests::HaveSameState(*Inventory, *Unchanged, NumItemTypes));
+	}
+
+	// Consumes may use items added by the same transaction
+	{
+		FInventoryTransaction Transaction = Inventory->BeginTransaction();
+		Transaction.AddItem(Potion, 4);
+		Transaction.ConsumeItem(Potion, 3);
+		TestEqual(TEXT("Consume of staged items"), (int32)Transaction.Commit(), (int32)InventoryError::ESuccess);
+		TestEqual(TEXT("Quantity after consuming staged items"), Inventory->GetItemQuantity(Potion), 1);
+	}
+
+	// ApplyOpsAtomic is all or nothing too
+	Unchanged->AddItem(Potion, 1);
+	TArray<FInventoryOp> Recipe = { MakeOp(InventoryOpType::EConsume, Potion), MakeOp(InventoryOpType::EAdd, Sword),
+		MakeOp(InventoryOpType::EConsume, FInventoryItemId(), 5) };
+	Recipe.Last().Name = InventoryTests::GetItemName(Ring.Index);
+	TestEqual(TEXT("Atomic ops"), (int32)Inventory->ApplyOpsAtomic(Recipe), (int32)InventoryError::ENoItemsToConsume);
+	TestTrue(TEXT("Failed atomic ops apply nothing"), InventoryTests::HaveSameState(*Inventory, *Unchanged, NumItemTypes));
+
+	return true;
+}
+
+#endif
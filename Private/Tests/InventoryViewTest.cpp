@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr int32 NumItemTypes = 30;
+
+	bool IsSameItem(const FInventoryItemView& View, const FInventoryItem& Item)
+	{
+		return View.Name == Item.Name && View.FlavorText == Item.FlavorText && View.Quantity == Item.Quantity
+			&& View.MaximumQuantity == Item.MaximumQuantity && View.bEquipped == Item.IsEquipped
+			&& View.bEquippable == Item.IsEquippable && View.bConsumable == Item.IsConsumable
+			&& View.Modifiers.Num() == Item.StatsBoostsAndDurations.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryViewTest, "InventorySystem.Views.Visitors",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryViewTest::RunTest(const FString& Parameters)
+{
+	UInventory* Inventory = InventoryTests::MakeInventory(NumItemTypes);
+
+	FRandomStream Random(6);
+	TArray<FInventoryOp> Ops;
+	for (int32 Step = 0; Step < 300; ++Step)
+	{
+		Ops.Add(InventoryTests::MakeRandomOp(Random, NumItemTypes));
+	}
+	Inventory->ApplyOps(Ops);
+
+	// Every item once, in item id order, with the fields GetItem copies
+	int32 NumVisited = 0;
+	Inventory->ForEachItem([&](const FInventoryItemView& View)
+	{
+		FInventoryItem Item;
+		TestEqual(TEXT("Visited in item id order"), View.ItemId.Index, NumVisited);
+		TestTrue(TEXT("Visited item"), Inventory->GetItem(View.ItemId, Item) && IsSameItem(View, Item));
+		++NumVisited;
+	});
+	TestEqual(TEXT("Visited items"), NumVisited, NumItemTypes);
+
+	int32 NumEquippedVisited = 0;
+	Inventory->ForEachEquippedItem([&](const FInventoryItemView& View)
+	{
+		FInventoryItem Item;
+		TestTrue(TEXT("Visited equipped item"), View.bEquipped && Inventory->GetItem(View.ItemId, Item) && IsSameItem(View, Item));
+		++NumEquippedVisited;
+	});
+	TestEqual(TEXT("Visited equipped items"), NumEquippedVisited, Inventory->GetEquippedItemIds().Num());
+
+	// Filling a reused array gives the same items as a fresh copy, whatever
+	// the array held before
+	TArray<FInventoryItem> Items;
+	Items.SetNum(NumItemTypes + 5);
+	for (FInventoryItem& Stale : Items)
+	{
+		Stale.Name = TEXT("Stale");
+		Stale.Quantity = 99;
+		Stale.StatsBoostsAndDurations.Add(TEXT("Stale"));
+	}
+	Inventory->GetInventoryInto(Items);
+	const TArray<FInventoryItem> Copied = Inventory->GetInventory();
+	if (!TestEqual(TEXT("Items"), Items.Num(), Copied.Num()))
+		return false;
+
+	for (int32 Index = 0; Index < Items.Num(); ++Index)
+	{
+		TestTrue(TEXT("Reused item"), Items[Index].Name == Copied[Index].Name && Items[Index].Quantity == Copied[Index].Quantity
+			&& Items[Index].IsEquipped == Copied[Index].IsEquipped
+			&& Items[Index].StatsBoostsAndDurations.OrderIndependentCompareEqual(Copied[Index].StatsBoostsAndDurations));
+	}
+
+	// The state views follow the inventory
+	const TConstArrayView<int32> Quantities = Inventory->GetQuantities();
+	for (int32 Index = 0; Index < NumItemTypes; ++Index)
+	{
+		const FInventoryItemId ItemId(Index);
+		TestEqual(TEXT("Quantity view"), Quantities[Index], Inventory->GetItemQuantity(ItemId));
+		TestEqual(TEXT("Equipped view"), (bool)Inventory->GetEquippedItemBits()[Index], Inventory->IsItemEquipped(ItemId));
+		TestTrue(TEXT("Registered view"), Inventory->GetRegisteredItems()[Index]);
+	}
+
+	return true;
+}
+
+#endif
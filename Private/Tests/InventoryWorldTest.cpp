@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Async/Async.h"
+#include "InventoryTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Adds item types with a held timed boost, a periodic boost and a boost
+	// held forever
+	void AddBoostItemTypes(UInventory& Inventory)
+	{
+		Inventory.AddPossibleStat(TEXT("Health"));
+		Inventory.AddPossibleStat(TEXT("Mana"));
+
+		FBoostAndDuration Timed;
+		Timed.Boost = 5;
+		Timed.Duration = 2;
+		Inventory.AddInventoryItemType(TEXT("Potion"), TEXT(""), nullptr, nullptr, { { TEXT("Health"), Timed } }, 10);
+
+		FBoostAndDuration Periodic;
+		Periodic.Boost = 1;
+		Periodic.Duration = 3;
+		Periodic.Period = 1;
+		Inventory.AddInventoryItemType(TEXT("Regen"), TEXT(""), nullptr, nullptr, { { TEXT("Health"), Periodic } }, 10);
+
+		FBoostAndDuration Forever;
+		Forever.Boost = 4;
+		Inventory.AddInventoryItemType(TEXT("Elixir"), TEXT(""), nullptr, nullptr, { { TEXT("Mana"), Forever } }, 10);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryWorldBatchedUpdateTest, "InventorySystem.World.BatchedUpdate",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryWorldBatchedUpdateTest::RunTest(const FString& Parameters)
+{
+	InventoryTests::FTestWorld TestWorld;
+	UInventoryWorldSubsystem* Subsystem = TestWorld.GetSubsystem();
+	if (!TestNotNull(TEXT("World subsystem"), Subsystem))
+		return false;
+
+	// Inventories register with the subsystem instead of ticking
+	UInventory* First = TestWorld.SpawnInventory();
+	UInventory* Second = TestWorld.SpawnInventory();
+	TestEqual(TEXT("Registered inventories"), Subsystem->GetInventories().Num(), 2);
+	TestFalse(TEXT("Inventories never tick"), First->PrimaryComponentTick.bCanEverTick);
+
+	AddBoostItemTypes(*First);
+	AddBoostItemTypes(*Second);
+	First->AddItem(TEXT("Potion"), 3);
+	First->AddItem(TEXT("Regen"), 1);
+	First->AddItem(TEXT("Elixir"), 1);
+	Second->AddItem(TEXT("Potion"), 1);
+
+	// Two potions consumed together are one boost of twice the size
+	First->ConsumeItem(TEXT("Potion"), 2);
+	First->ConsumeItem(TEXT("Regen"));
+	First->ConsumeItem(TEXT("Elixir"));
+	Second->ConsumeItem(TEXT("Potion"));
+	TestEqual(TEXT("Timed boosts scheduled"), Subsystem->NumTimedBoosts(), 3);
+	TestEqual(TEXT("Held boost"), First->GetActiveBoostTotal(TEXT("Health")), 10);
+	TestEqual(TEXT("Boost held forever"), First->GetActiveBoostTotal(TEXT("Mana")), 4);
+	TestEqual(TEXT("Held boost of the other inventory"), Second->GetActiveBoostTotal(TEXT("Health")), 5);
+
+	// Halfway through, everything is still held
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		Subsystem->Tick(0.1f);
+	}
+	TestEqual(TEXT("Held boost before its expiry"), First->GetActiveBoostTotal(TEXT("Health")), 10);
+	TestEqual(TEXT("Timed boosts before their expiry"), Subsystem->NumTimedBoosts(), 3);
+
+	// Expiry ends the held boosts of both inventories, the periodic boost
+	// still pulses
+	Subsystem->Tick(1.05f);
+	TestEqual(TEXT("Held boost after its expiry"), First->GetActiveBoostTotal(TEXT("Health")), 0);
+	TestEqual(TEXT("Held boost of the other inventory after its expiry"), Second->GetActiveBoostTotal(TEXT("Health")), 0);
+	TestEqual(TEXT("Boost held forever after the expiry"), First->GetActiveBoostTotal(TEXT("Mana")), 4);
+	TestEqual(TEXT("Periodic boost left"), Subsystem->NumTimedBoosts(), 1);
+
+	Subsystem->Tick(1.0f);
+	TestEqual(TEXT("Every timed boost expired"), Subsystem->NumTimedBoosts(), 0);
+
+	// Destroyed inventories leave the update, their timed boosts are dropped
+	// when they fire
+	Second->AddItem(TEXT("Potion"), 1);
+	Second->ConsumeItem(TEXT("Potion"));
+	TestEqual(TEXT("Timed boost of an inventory about to be destroyed"), Subsystem->NumTimedBoosts(), 1);
+
+	TestWorld.Actors.Last()->Destroy();
+	TestEqual(TEXT("Registered inventories after a destroy"), Subsystem->GetInventories().Num(), 1);
+	TestTrue(TEXT("The playing inventory stays registered"), Subsystem->GetInventories()[0] == First);
+
+	Subsystem->Tick(2.1f);
+	TestEqual(TEXT("Timed boost of a destroyed inventory dropped"), Subsystem->NumTimedBoosts(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryWorldQueuedOpsTest, "InventorySystem.World.QueuedOps",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryWorldQueuedOpsTest::RunTest(const FString& Parameters)
+{
+	InventoryTests::FTestWorld TestWorld;
+	UInventoryWorldSubsystem* Subsystem = TestWorld.GetSubsystem();
+	if (!TestNotNull(TEXT("World subsystem"), Subsystem))
+		return false;
+
+	// Every thread works on an item type of its own, so the results do not
+	// depend on how the threads interleave, only on the order each thread
+	// queued its batches in
+	constexpr int32 NumThreads = 8;
+	constexpr int32 NumBatches = 50;
+	constexpr int32 NumOpsPerBatch = 10;
+
+	UInventory* Inventory = TestWorld.SpawnInventory();
+	InventoryTests::AddTestItemTypes(*Inventory, NumThreads);
+	UInventory* Reference = InventoryTests::MakeInventory(NumThreads, Inventory->GetCatalog());
+
+	TArray<TArray<FInventoryOp>> Batches;
+	TArray<TArray<InventoryError>> Results;
+	TArray<int32> NumCallbacks;
+	FRandomStream Random(19);
+	for (int32 Thread = 0; Thread < NumThreads; ++Thread)
+	{
+		for (int32 Batch = 0; Batch < NumBatches; ++Batch)
+		{
+			TArray<FInventoryOp>& Ops = Batches.AddDefaulted_GetRef();
+			for (int32 Step = 0; Step < NumOpsPerBatch; ++Step)
+			{
+				FInventoryOp& Op = Ops.Add_GetRef(InventoryTests::MakeRandomOp(Random, NumThreads));
+				Op.ItemId = FInventoryItemId(Thread);
+			}
+		}
+	}
+	Results.SetNum(Batches.Num());
+	NumCallbacks.Init(0, Batches.Num());
+
+	TArray<TFuture<void>> Threads;
+	for (int32 Thread = 0; Thread < NumThreads; ++Thread)
+	{
+		Threads.Add(Async(EAsyncExecution::Thread, [&, Thread]()
+		{
+			for (int32 Batch = Thread * NumBatches; Batch < (Thread + 1) * NumBatches; ++Batch)
+			{
+				Subsystem->EnqueueOps(Inventory, TArray<FInventoryOp>(Batches[Batch]), [&Results, &NumCallbacks, Batch](TConstArrayView<InventoryError> BatchResults)
+				{
+					Results[Batch] = TArray<InventoryError>(BatchResults);
+					++NumCallbacks[Batch];
+				});
+			}
+		}));
+	}
+	for (TFuture<void>& Thread : Threads)
+	{
+		Thread.Wait();
+	}
+
+	UInventory* Empty = InventoryTests::MakeInventory(NumThreads, Inventory->GetCatalog());
+	TestTrue(TEXT("Nothing applied before the update"), InventoryTests::HaveSameState(*Inventory, *Empty, NumThreads));
+	TestEqual(TEXT("No callback before the update"), NumCallbacks.IndexOfByPredicate([](const int32 Count) { return Count != 0; }), INDEX_NONE);
+
+	// One update applies every queued batch and calls back with the results
+	// ApplyOps gives on the reference
+	Subsystem->Tick(0.1f);
+	for (int32 Batch = 0; Batch < Batches.Num(); ++Batch)
+	{
+		if (!TestEqual(TEXT("Callbacks of a batch"), NumCallbacks[Batch], 1))
+			return false;
+
+		TestTrue(TEXT("Results of a queued batch"), Results[Batch] == Reference->ApplyOps(Batches[Batch]));
+	}
+	TestTrue(TEXT("State after the queued batches"), InventoryTests::HaveSameState(*Inventory, *Reference, NumThreads));
+
+	// Operations on destroyed inventories all fail, batches queued by a
+	// callback wait for the next update
+	UInventory* Destroyed = TestWorld.SpawnInventory();
+	InventoryTests::AddTestItemTypes(*Destroyed, NumThreads);
+	TestWorld.Actors.Last()->Destroy();
+
+	TArray<InventoryError> DestroyedResults;
+	TArray<InventoryError> NestedResults;
+	TArray<FInventoryOp> Ops = { InventoryTests::MakeRandomOp(Random, NumThreads), InventoryTests::MakeRandomOp(Random, NumThreads) };
+	Subsystem->EnqueueOps(Destroyed, TArray<FInventoryOp>(Ops), [&](TConstArrayView<InventoryError> BatchResults)
+	{
+		DestroyedResults = TArray<InventoryError>(BatchResults);
+		Subsystem->EnqueueOps(nullptr, TArray<FInventoryOp>(Ops), [&NestedResults](TConstArrayView<InventoryError> NestedBatchResults)
+		{
+			NestedResults = TArray<InventoryError>(NestedBatchResults);
+		});
+	});
+
+	Subsystem->Tick(0.1f);
+	TestTrue(TEXT("Ops on a destroyed inventory"), DestroyedResults == TArray<InventoryError>({ InventoryError::EInvalidItemType,
+		InventoryError::EInvalidItemType }));
+	TestEqual(TEXT("Batch queued by a callback waits"), NestedResults.Num(), 0);
+
+	Subsystem->Tick(0.1f);
+	TestTrue(TEXT("Ops without an inventory"), NestedResults == TArray<InventoryError>({ InventoryError::EInvalidItemType,
+		InventoryError::EInvalidItemType }));
+
+	return true;
+}
+
+#endif
@@ -3,87 +3,32 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Engine/Texture2D.h"
 #include "UObject/ObjectMacros.h"
 #include "Components/ActorComponent.h"
+#include "InventoryTypes.h"
+#include "InventoryCatalog.h"
+#include "InventoryTransaction.h"
+#include "InventorySnapshot.h"
 #include "Inventory.generated.h"
 
-UENUM(BlueprintType)
-enum class InventoryError : uint8
-{
-	ESuccess					UMETA(DisplayName = "Success"),
-	EInvalidStatUsed			UMETA(DisplayName = "InvalidStatUsed"), 
-	EDuplicateItemType			UMETA(DisplayName = "DuplicateItemType"),
-	EInvalidItemType			UMETA(DisplayName = "InvalidItemType"),
-	EMaxQuantityExceeded		UMETA(DisplayName = "MaxQuantityExceeded"),
-	ENoItemsToConsume			UMETA(DisplayName = "NoItemsToConsume"),
-	ENotEquippable				UMETA(DisplayName = "NotEquippable"),
-	EAlreadyEquipped			UMETA(DisplayName = "AlreadyEquipped"),
-	ENotEquipped				UMETA(DisplayName = "NotEquipped"),
-	ENotConsumable				UMETA(DisplayName = "NotConsumable"),
-	EDuplicateStat				UMETA(DisplayName = "DuplicateStat")
-};
-
-USTRUCT(BlueprintType)
-struct FBoostAndDuration
-{
-	GENERATED_BODY()
-
-	// The boost to give to the desired stat
-	UPROPERTY(BlueprintReadWrite, Category = "BoostAndDuration")
-	int Boost = 0;
+class UInventoryWorldSubsystem;
 
-	// The duration of the effect. 0 indicates no duration (i.e infinite). Negative values treated as 0.
-	UPROPERTY(BlueprintReadWrite, Category = "BoostAndDuration")
-	int Duration = 0;
-};
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryBoostEvents, const TArray<FInventoryBoostEvent>&, Events);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryChanged, const TArray<FInventoryItemChange>&, Changes);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInventoryItemChanged, const FInventoryItemChange& /* Change */);
 
-USTRUCT(BlueprintType)
-struct FInventoryItem
+// A non-owning view of one inventory item, only valid while it is visited.
+struct FInventoryItemView
 {
-	GENERATED_BODY()
-
-	// The name of this inventory item
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	FString Name = "";
-
-	// The flavor text of this inventory item
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	FString FlavorText = "";
-
-	// The thumbnail of this inventory item
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	UTexture2D* Thumbnail = nullptr;
-
-	// The full image of this inventory item
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	UTexture2D* FullImage = nullptr;
-
-	// A TMap containing strings specifying a stat and a BoostAndDuration 
-	// struct which specifies the boost to the respective stat as well as the
-	// duration of the boost.
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	TMap<FString, FBoostAndDuration> StatsBoostsAndDurations;
-
-	// The current quantity of this inventory item. Negative values treated as 0.
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	int Quantity = 0;
-
-	// The maximum allowable quantity of this inventory item. Negative values treated as 0.
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	int MaximumQuantity = 0;
-
-	// Is this item equippable?
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	bool IsEquippable = false;
-
-	// Is this item equipped?
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	bool IsEquipped = false;
-
-	// Is this this item consumable?
-	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
-	bool IsConsumable = false;
+	FInventoryItemId ItemId;
+	FStringView Name;
+	FStringView FlavorText;
+	TConstArrayView<FInventoryStatModifier> Modifiers;
+	int32 Quantity = 0;
+	int32 MaximumQuantity = 0;
+	bool bEquipped = false;
+	bool bEquippable = false;
+	bool bConsumable = false;
 };
 
 UCLASS( ClassGroup=(Inventory), meta=(BlueprintSpawnableComponent) )
@@ -113,6 +58,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	TArray<FString> GetPossibleStats();
 
+	/** Visit the possible stats of this inventory without copying them.
+	 * @param Visitor - Called with the stat id and name of each possible stat.
+	 */
+	void ForEachPossibleStat(TFunctionRef<void(int32 StatId, FStringView StatName)> Visitor) const;
+
 	/** Adds an inventory item type. Ideally should add all possible items 
 	 * once on BeginPlay.
 	 * @param Name - The name of this inventory item.
@@ -138,11 +88,89 @@ public:
 									const FString& FlavorText, 
 									const UTexture2D* Thumbnail, 
 									const UTexture2D* FullImage,
-									const TMap<FString, FBoostAndDuration> StatsBoostsAndDurations,
+									const TMap<FString, FBoostAndDuration>& StatsBoostsAndDurations,
 									const int MaximumQuantity = 1,
 									const bool IsConsumable = true,
 									const bool IsEquippable = false);
 
+	/** Adds an inventory item type and returns its handle. See above.
+	 * @param OutItemId - Set to the handle of the newly added item type on
+	 * success, or to the handle of the existing item type on
+	 * EDuplicateItemType. Left invalid otherwise.
+	 */
+	InventoryError AddInventoryItemType(FInventoryItemId& OutItemId,
+									const FString& Name,
+									const FString& FlavorText, 
+									const UTexture2D* Thumbnail, 
+									const UTexture2D* FullImage,
+									const TMap<FString, FBoostAndDuration>& StatsBoostsAndDurations,
+									const int MaximumQuantity = 1,
+									const bool IsConsumable = true,
+									const bool IsEquippable = false);
+
+	/** Adds many inventory item types at once. Prefer this over repeated
+	 * AddInventoryItemType calls for large catalogs, storage is reserved up
+	 * front and every definition is moved instead of copied.
+	 * @param Definitions - The item type definitions. Emptied by the call.
+	 * @param OutItemIds - Filled with the handle of each definition as
+	 * AddInventoryItemType would set it.
+	 * @param OutResults - Filled with the result of each definition as 
+	 * AddInventoryItemType would return it.
+	 * @return ESuccess if every item type was added, otherwise the first 
+	 * error in OutResults.
+	 */
+	InventoryError AddInventoryItemTypes(TArray<FInventoryItemDefinition>&& Definitions, TArray<FInventoryItemId>& OutItemIds, 
+										TArray<InventoryError>& OutResults);
+
+	/** Adds every row of a DataTable as an inventory item type. Ideally 
+	 * should add all possible items once on BeginPlay.
+	 * @param ItemTable - A DataTable with FInventoryItemDefinition rows.
+	 * @return ESuccess if every item type was added. EInvalidItemType if 
+	 * ItemTable does not have FInventoryItemDefinition rows. Otherwise the
+	 * first error any row would get from AddInventoryItemType.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	InventoryError AddInventoryItemTypesFromDataTable(const UDataTable* ItemTable);
+
+	/** Resolves the name of an inventory item type to its handle. Resolve 
+	 * once at setup and use the handle based overloads on hot paths.
+	 * @param Name - The name of an inventory item type.
+	 * @return The handle of the item type, or an invalid handle if no item 
+	 * type with this name exists in the inventory.
+	 */
+	FInventoryItemId FindItemId(FStringView Name) const;
+
+	/** Get an inventory item by handle
+	 * @param OutItem - Filled with the item if ItemId is an item type in this
+	 * inventory.
+	 * @return true if ItemId is an item type in this inventory.
+	 */
+	bool GetItem(const FInventoryItemId ItemId, FInventoryItem& OutItem) const;
+
+	/** Get the current quantity of an inventory item by handle
+	 * @return The quantity, or 0 if ItemId is not an item type in this 
+	 * inventory.
+	 */
+	int32 GetItemQuantity(const FInventoryItemId ItemId) const;
+
+	/** Is an inventory item equipped?
+	 * @return true if ItemId is an item type in this inventory and is
+	 * equipped.
+	 */
+	bool IsItemEquipped(const FInventoryItemId ItemId) const;
+
+	/** Get the catalog holding the item type definitions of this inventory.
+	 * Resolves the catalog shared by the game instance on first use.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	UInventoryCatalog* GetCatalog();
+
+	/** Use a specific catalog for this inventory instead of the one shared by
+	 * the game instance. Must be called before any item types are added.
+	 * @return true if the catalog was set.
+	 */
+	bool SetCatalog(UInventoryCatalog* InCatalog);
+
 	/** Add a desired quantity of an item in the inventory
 	 * @param ItemToAdd is a string containing the name of an item in the
 	 * inventory to add quantity to.
@@ -156,6 +184,7 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	InventoryError AddItem(const FString& ItemToAdd, const int Quantity = 1);
+	InventoryError AddItem(const FInventoryItemId ItemToAdd, const int Quantity = 1);
 
 	/** Consume a desired quantity of an item in the inventory. ItemToConsume
 	 * must be consumable. If Quantity is greater than quantity of ItemToConsume,
@@ -172,6 +201,7 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	InventoryError ConsumeItem(const FString& ItemToConsume, const int Quantity = 1);
+	InventoryError ConsumeItem(const FInventoryItemId ItemToConsume, const int Quantity = 1);
 
 	/** Equip an item in the inventory. This sets the isEquipped field of
 	 * ItemToEquip to true. ItemToEquip must be equippable. Quantity of
@@ -185,6 +215,7 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	InventoryError EquipItem(const FString& ItemToEquip);
+	InventoryError EquipItem(const FInventoryItemId ItemToEquip);
 	
 	/** Unequip an item in the inventory. This sets the isEquipped field of
 	 * ItemToUnequip to false. ItemToUnequip must be equippable. Quantity of
@@ -198,29 +229,527 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	InventoryError UnequipItem(const FString& ItemToUnequip);
+	InventoryError UnequipItem(const FInventoryItemId ItemToUnequip);
 	
+	/** Add several items in one call. Item names are resolved in a single
+	 * pass, then each stack is added in order exactly as AddItem would.
+	 * @param Items - The item types and quantities to add.
+	 * @return The result of each stack, in the order of Items.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<InventoryError> AddItems(const TArray<FInventoryItemStack>& Items);
+
+	/** Consume several items in one call. Item names are resolved in a 
+	 * single pass, then each stack is consumed in order exactly as 
+	 * ConsumeItem would.
+	 * @param Items - The item types and quantities to consume.
+	 * @return The result of each stack, in the order of Items.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<InventoryError> ConsumeItems(const TArray<FInventoryItemStack>& Items);
+
+	/** Apply a mixed list of operations in one call. Item names are resolved
+	 * in a single pass, then each operation is applied in order, so later 
+	 * operations see the effect of earlier ones. A failing operation does 
+	 * not stop the others.
+	 * @param Ops - The operations to apply.
+	 * @return The result of each operation, in the order of Ops.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<InventoryError> ApplyOps(const TArray<FInventoryOp>& Ops);
+
+	// As above, writing the results into a caller owned array
+	void ApplyOps(TConstArrayView<FInventoryOp> Ops, TArray<InventoryError>& OutResults);
+
+	/** Start a transaction that stages changes to this inventory and applies
+	 * them all or not at all on Commit.
+	 */
+	FInventoryTransaction BeginTransaction() { return FInventoryTransaction(*this); }
+
+	/** Apply a list of operations as a single transaction, e.g. the inputs 
+	 * and outputs of a crafting recipe. 
+	 * @param Ops - The operations to apply. Consume operations need the whole
+	 * quantity to be available.
+	 * @return ESuccess if every operation was applied. Otherwise the error of
+	 * the first failing operation, and nothing is applied.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	InventoryError ApplyOpsAtomic(const TArray<FInventoryOp>& Ops);
+
 	/** Get the current inventory 
 	 * @return TMap containing all inventory items and their counts.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	TArray<FInventoryItem> GetInventory();
 
+	/** Get the current inventory into a caller owned array. Elements already
+	 * in OutItems are overwritten in place so their strings and maps reuse 
+	 * their allocations.
+	 * @param OutItems - Filled with all inventory items.
+	 */
+	void GetInventoryInto(TArray<FInventoryItem>& OutItems) const;
+
+	/** Visit every item of this inventory without copying anything. The
+	 * inventory must not be mutated from Visitor.
+	 * @param Visitor - Called with a view of each item in item id order.
+	 */
+	void ForEachItem(TFunctionRef<void(const FInventoryItemView& Item)> Visitor) const;
+
+	/** Visit every equipped item of this inventory without copying anything.
+	 * The inventory must not be mutated from Visitor.
+	 * @param Visitor - Called with a view of each equipped item.
+	 */
+	void ForEachEquippedItem(TFunctionRef<void(const FInventoryItemView& Item)> Visitor) const;
+
+	// Views of the per item state, indexed by FInventoryItemId::Index
+	TConstArrayView<int32> GetQuantities() const { return Quantities; }
+	const TBitArray<>& GetRegisteredItems() const { return RegisteredItems; }
+	const TBitArray<>& GetEquippedItemBits() const { return EquippedItems; }
+
 	/** Get equipped items
 	 * @return TSet containing all currently equipped inventory items.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	TArray<FInventoryItem> GetEquippedItems();
 
+	/** Get equipped items into a caller owned array. Costs proportional to 
+	 * the number of equipped items and does not allocate once OutItems has
+	 * enough capacity.
+	 * @param OutItems - Reset and filled with all currently equipped items.
+	 */
+	void GetEquippedItemsInto(TArray<FInventoryItem>& OutItems) const;
+
+	/** Get the handles of all equipped items, in no particular order.
+	 * @return View of the equipped set. Invalidated by EquipItem and 
+	 * UnequipItem.
+	 */
+	TConstArrayView<FInventoryItemId> GetEquippedItemIds() const { return EquippedItemIds; }
+
+	/** Get the generation of this inventory. The generation increases every
+	 * time the quantity or equip state of an item changes, so consumers can 
+	 * skip all work while it stays the same.
+	 * @return The current generation. 0 if nothing ever changed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int64 GetGeneration() const { return Generation; }
+
+	/** Get the generation at which an item last changed
+	 * @return The generation, or 0 if the item never changed or ItemId is not
+	 * an item type in this inventory.
+	 */
+	int64 GetItemGeneration(const FInventoryItemId ItemId) const
+	{
+		return IsRegistered(ItemId) ? ItemGenerations[ItemId.Index] : 0;
+	}
+
+	/** Get the items whose quantity or equip state changed after a 
+	 * generation. Costs proportional to the number of changes since then.
+	 * @param SinceGeneration - A generation previously returned by 
+	 * GetGeneration or GetChangesSince. Pass 0 to get every item that ever
+	 * changed.
+	 * @param OutChangedItems - Reset and filled with each changed item once,
+	 * most recently changed first.
+	 * @return The current generation, to pass in on the next call.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int64 GetChangesSince(const int64 SinceGeneration, TArray<FInventoryItemId>& OutChangedItems) const;
+
+	/** Start publishing snapshots of the per item state for GetSnapshot. 
+	 * Inventories nobody reads from other threads never copy their state, so
+	 * publishing is off until a reader asks for it. Publishes the current 
+	 * state right away if it changed since the last snapshot, and from then
+	 * on at the end of every frame this inventory changed in. Call on the
+	 * game thread.
+	 */
+	void EnableSnapshots();
+
+	/** Get the snapshot of the per item state published at the end of the
+	 * last frame this inventory changed in. Safe to call from any thread 
+	 * while the inventory is alive, the snapshot itself stays valid for as 
+	 * long as it is referenced.
+	 * @return The snapshot, or null before EnableSnapshots was called.
+	 */
+	FInventorySnapshotPtr GetSnapshot() const { return SnapshotPublisher.Acquire(); }
+
+	/** Save the per item state of this inventory in a compact binary format.
+	 * Only the quantity and equip state of items that are owned or equipped
+	 * are written, keyed by item id, together with the fingerprint of the 
+	 * catalog the ids belong to. Active boosts are not saved.
+	 * @param OutData - Reset and filled with the saved state.
+	 */
+	void SaveState(TArray<uint8>& OutData) const;
+
+	/** Restore state written by SaveState. Items not in the saved state end
+	 * up with a quantity of 0 and unequipped. The saved item types must be
+	 * registered with this inventory before loading.
+	 * @param Data - A saved state.
+	 * @return true if the state was restored. false if Data is not a valid 
+	 * saved state, was saved against a different catalog, or holds a state
+	 * this inventory cannot have. Nothing changes in that case.
+	 */
+	bool LoadState(TConstArrayView<uint8> Data);
+
+	/** Get the owned items boosting a stat, highest boost first. Maintained
+	 * as quantities change, so this costs nothing but the view.
+	 * @param StatId - A catalog stat id.
+	 * @param Filter - Which owned items to include.
+	 * @return View of the index, invalidated by any change to the inventory.
+	 */
+	TConstArrayView<FInventoryStatIndexEntry> GetOwnedItemsByStat(const int32 StatId, const InventoryItemFilter Filter = InventoryItemFilter::EAll) const;
+
+	/** Get the owned item with the highest boost to a stat, e.g. the best 
+	 * healing item.
+	 * @param Stat - The name of a possible stat of this inventory.
+	 * @param Filter - Which owned items to consider.
+	 * @return The item, or an invalid handle if no owned item boosts Stat.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	FInventoryItemId GetBestOwnedItemForStat(const FString& Stat, const InventoryItemFilter Filter = InventoryItemFilter::EAll) const;
+
+	/** Get the owned items boosting a stat, highest boost first.
+	 * @param Stat - The name of a possible stat of this inventory.
+	 * @param Filter - Which owned items to include.
+	 * @return The items, empty if Stat is not a stat.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<FInventoryItemId> GetOwnedItemsBoostingStat(const FString& Stat, const InventoryItemFilter Filter = InventoryItemFilter::EAll) const;
+
+	/** Get a page of the owned items in a stable sorted order, e.g. the 
+	 * visible rows of a scrolling list. The orders are maintained as 
+	 * quantities change, so a page costs O(Count).
+	 * @param SortKey - The order. Ties are broken by item id.
+	 * @param StatId - The catalog stat id to sort by for EStatBoost. Only 
+	 * owned items boosting the stat are in that order.
+	 * @param bDescending - Reverse the order. Names and quantities ascend and
+	 * boosts descend otherwise.
+	 * @param Offset - The position of the first item of the page.
+	 * @param Count - The maximum number of items in the page.
+	 * @param OutItems - Reset and filled with the items of the page.
+	 * @return The number of items in the whole order.
+	 */
+	int32 GetInventoryPage(const InventorySortKey SortKey, const int32 StatId, const bool bDescending, 
+						const int32 Offset, const int32 Count, TArray<FInventoryItemId>& OutItems) const;
+
+	/** Get a page of the owned items in a stable sorted order. See above.
+	 * @param Stat - The name of the stat to sort by for EStatBoost.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<FInventoryItem> GetInventoryPage(const InventorySortKey SortKey, const FString& Stat, const bool bDescending, 
+										const int Offset, const int Count) const;
+
+	/** Get the owned items sorted by several keys at once, e.g. for a sort
+	 * inventory button. Uses a radix sort over packed integer keys.
+	 * @param Order - The keys to sort by.
+	 * @return The owned items in order.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<FInventoryItemId> SortItems(const FInventorySortOrder& Order) const;
+
+	/** Sort items of this inventory by several keys at once.
+	 * @param InOutItemIds - Item types of this inventory, sorted in place.
+	 */
+	void SortItems(const FInventorySortOrder& Order, TArray<FInventoryItemId>& InOutItemIds) const;
+
+	/** Search the owned items by name, ignoring case. Uses the name indexes
+	 * of the catalog, which are built on the first search after item types
+	 * were added, see UInventoryCatalog::BuildNameIndexes. Walks the owned
+	 * items instead when there are far fewer of them than names the indexes
+	 * list for the query.
+	 * @param Query - The text to search for.
+	 * @param bPrefix - Only match names starting with Query instead of names
+	 * containing it.
+	 * @param MaxResults - Stop after this many matches.
+	 * @return The matching owned items. In name order for prefix searches,
+	 * in item id order otherwise.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	TArray<FInventoryItemId> SearchItems(const FString& Query, const bool bPrefix = false, const int MaxResults = 100) const;
+
+	// As above, writing the matches into a caller owned array
+	void SearchItems(FStringView Query, const bool bPrefix, const int32 MaxResults, TArray<FInventoryItemId>& OutItems) const;
+
+	// Bits indexed by FInventoryItemId::Index of the owned consumable and 
+	// owned equippable items. Iterate with TConstSetBitIterator.
+	const TBitArray<>& GetOwnedConsumableItems() const { return OwnedConsumableItems; }
+	const TBitArray<>& GetOwnedEquippableItems() const { return OwnedEquippableItems; }
+
+	/** Get the total boost to a stat from all equipped items
+	 * @param Stat - The name of a possible stat of this inventory.
+	 * @return The sum of the boosts of all equipped items to Stat, 0 if no
+	 * equipped item boosts it or it is not a stat.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int GetEquippedStatTotal(const FString& Stat) const;
+
+	// As above by catalog stat id, O(1)
+	int32 GetEquippedStatTotal(const int32 StatId) const
+	{
+		return EquippedStatTotals.IsValidIndex(StatId) ? EquippedStatTotals[StatId] : 0;
+	}
+
+	// The equipped stat totals indexed by catalog stat id. Stats past the end
+	// of the view have a total of 0.
+	TConstArrayView<int32> GetEquippedStatTotals() const { return EquippedStatTotals; }
+
+	/** Recomputes the equipped stat totals from scratch, without touching the
+	 * incrementally maintained totals.
+	 * @param OutStatTotals - Reset and filled with the totals indexed by 
+	 * catalog stat id, sized to the number of stats in the catalog.
+	 */
+	void RecomputeEquippedStatTotals(TArray<int32>& OutStatTotals) const;
+
+	/** Checks the incrementally maintained stat totals against a full
+	 * recompute. Intended for debug validation.
+	 * @return true if they match.
+	 */
+	bool ValidateEquippedStatTotals() const;
+
+	/** Get the total boost to a stat from consumed items. Consuming an item
+	 * holds each of its non periodic boosts for the boost's duration, or 
+	 * forever if it has none. Boosts with a duration are only held by 
+	 * inventories in a world, which times them.
+	 * @param Stat - The name of a possible stat of this inventory.
+	 * @return The sum of the active boosts to Stat.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int GetActiveBoostTotal(const FString& Stat) const;
+
+	// As above by catalog stat id, O(1)
+	int32 GetActiveBoostTotal(const int32 StatId) const
+	{
+		return ActiveBoostTotals.IsValidIndex(StatId) ? ActiveBoostTotals[StatId] : 0;
+	}
+
+	/** Get the name of a stat by catalog stat id, e.g. from an 
+	 * FInventoryBoostEvent.
+	 * @return The stat name, or an empty string if StatId is not a stat.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	FString GetStatName(const int StatId) const;
+
+	// Broadcast once per frame with every boost of this inventory that 
+	// expired or pulsed in that frame.
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryBoostEvents OnBoostEvents;
+
+	// Broadcast at the end of every frame in which items of this inventory 
+	// changed, with one change per item no matter how often it changed.
+	// Items that changed back to their old state are left out.
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryChanged OnInventoryChanged;
+
+	/** Subscribe to the changes of a single item. Called at the end of every
+	 * frame in which the item changed, before OnInventoryChanged.
+	 * @return The handle to unsubscribe with.
+	 */
+	FDelegateHandle SubscribeToItem(const FInventoryItemId ItemId, FOnInventoryItemChanged::FDelegate&& Delegate);
+
+	// Removes a subscription added by SubscribeToItem
+	void UnsubscribeFromItem(const FInventoryItemId ItemId, const FDelegateHandle Handle);
+
+	// Is ItemId an item type registered with this inventory?
+	bool IsRegistered(const FInventoryItemId ItemId) const
+	{
+		return RegisteredItems.IsValidIndex(ItemId.Index) && RegisteredItems[ItemId.Index];
+	}
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-	
+	// Called when the game ends or the component is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
-	TSet<FString> PossibleStats;
+	// Every quantity and equip state change goes through these, they keep 
+	// the equipped set and change tracking up to date.
+	void SetQuantity(const int32 Index, const int32 NewQuantity);
+	void SetEquipped(const int32 Index, const bool bNewEquipped);
+
+	// Adds or removes an item from the owned item indexes
+	void UpdateOwnedIndexes(const int32 Index, const bool bOwned);
+
+	// Moves an owned item in the quantity order
+	void UpdateOwnedByQuantity(const int32 Index, const int32 OldQuantity, const int32 NewQuantity);
+
+	// Adds or removes an item from the name order, unless it is stale or the
+	// catalog name indexes need rebuilding
+	void UpdateOwnedByName(const int32 Index, const bool bOwned);
+
+	// Rebuilds the name order if the catalog name ranks changed
+	void RefreshOwnedByName() const;
+
+	// Adds Sign times the modifiers of an item to the equipped stat totals
+	void ApplyEquippedModifiers(const int32 Index, const int32 Sign);
+
+	// Grows the per item state to hold at least NumItems item types
+	void ReserveItemStates(const int32 NumItems);
+
+	// Registers a catalog item type with this inventory
+	InventoryError RegisterItemType(const FInventoryItemId ItemId);
+
+	// Resolves the item type of a batch entry
+	FInventoryItemId ResolveItemId(const FInventoryItemId ItemId, const FString& Name) const
+	{
+		return ItemId.IsValid() ? ItemId : FindItemId(Name);
+	}
+
+	// Applies one resolved batch entry
+	InventoryError ApplyOp(const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity);
+
+	// Starts the boosts of Count consumed items
+	void StartConsumedBoosts(const int32 Index, const int32 Count);
+
+	// Applies a batch of expired and pulsed boosts and broadcasts them
+	void HandleBoostEvents(TConstArrayView<FInventoryBoostEvent> Events);
+
+	// Ends a non periodic boost of a consumed item
+	void RemoveActiveBoost(const int32 StatId, const int32 Boost);
+
+	friend class UInventoryWorldSubsystem;
+	friend class FInventoryTransaction;
+	friend struct FInventoryDeltaSerializer;
+
+	// The index of this inventory in UInventoryWorldSubsystem, INDEX_NONE 
+	// while not playing.
+	int32 WorldIndex = INDEX_NONE;
+
+	// The subsystem of the world this inventory plays in, set on BeginPlay
+	// and cleared on EndPlay. Null while not playing, timed boosts are not
+	// started then.
+	UInventoryWorldSubsystem* WorldSubsystem = nullptr;
+
+	// The index of this inventory in the dirty inventories of WorldSubsystem,
+	// INDEX_NONE if it has nothing to flush or publish this frame.
+	int32 DirtyIndex = INDEX_NONE;
+
+	// Queues this inventory for the end of frame flush and publish
+	void MarkDirty();
+
+	// Records a change to an item in the change log
+	void MarkItemChanged(const int32 Index);
+
+	// Drops log entries that were superseded by later changes to their item
+	void CompactChangeLog();
+
+	// Publishes a snapshot if snapshots are enabled and anything changed 
+	// since the last one. Called by UInventoryWorldSubsystem at the end of 
+	// every frame this inventory changed in.
+	void PublishSnapshot();
+
+	// Records a change for the change notifications, before it is applied
+	void RecordChange(const int32 Index);
+
+	// Broadcasts the changes recorded this frame. Called by 
+	// UInventoryWorldSubsystem at the end of every frame this inventory 
+	// changed in.
+	void FlushChanges();
+
+	// Fills the Blueprint facing view of an item
+	void FillInventoryItem(const int32 Index, FInventoryItem& OutItem) const;
+
+	// Builds the non-owning view of an item
+	FInventoryItemView MakeItemView(const int32 Index) const;
+
+	// Bits indexed by catalog stat id of the stats added to this inventory
+	TBitArray<> PossibleStats;
+
+	UPROPERTY(Transient)
+	UInventoryCatalog* Catalog = nullptr;
+
+	// The mutable per item state, indexed by FInventoryItemId::Index. Kept in
+	// parallel arrays so scans only stream through the field they need. Only
+	// grows as far as the highest item type registered with this inventory.
+	TArray<int32> Quantities;
+	TBitArray<> RegisteredItems;
+	TBitArray<> EquippedItems;
+
+	// Dense set of the equipped items, maintained by EquipItem and 
+	// UnequipItem so equipped queries never scan the whole inventory.
+	TArray<FInventoryItemId> EquippedItemIds;
+
+	// Owned items are items with a quantity above 0. Both are maintained by
+	// SetQuantity, like the per stat indexes below.
+	TBitArray<> OwnedConsumableItems;
+	TBitArray<> OwnedEquippableItems;
+
+	// The owned items boosting a stat, sorted like the catalog indexes
+	struct FOwnedStatIndex
+	{
+		// Indexed by InventoryItemFilter
+		TArray<FInventoryStatIndexEntry> Entries[3];
+	};
+
+	// Indexed by catalog stat id. Grows on demand to the highest stat id any
+	// owned item boosts.
+	TArray<FOwnedStatIndex> OwnedItemsByStat;
+
+	struct FQuantityIndexEntry
+	{
+		int32 Quantity;
+		int32 Index;
+
+		bool operator<(const FQuantityIndexEntry& Other) const
+		{
+			return Quantity != Other.Quantity ? Quantity < Other.Quantity : Index < Other.Index;
+		}
+	};
+
+	// The owned items by ascending quantity
+	TArray<FQuantityIndexEntry> OwnedItemsByQuantity;
+
+	// The owned items by catalog name rank. Only maintained while 
+	// OwnedByNameVersion matches the catalog name index version and the 
+	// indexes are built, rebuilt by the next page query otherwise.
+	mutable TArray<FInventoryItemId> OwnedItemsByName;
+	mutable uint32 OwnedByNameVersion = 0;
+
+	// The sum of the boosts of all equipped items indexed by catalog stat id.
+	// Grows on demand to the highest stat id any equipped item boosts.
+	TArray<int32> EquippedStatTotals;
+
+	// The sum of the active boosts of consumed items indexed by catalog stat
+	// id. Grows on demand like EquippedStatTotals.
+	TArray<int32> ActiveBoostTotals;
+
+	// Incremented on every item change
+	int64 Generation = 0;
+
+	// The generation each item last changed at, indexed by FInventoryItemId::Index
+	TArray<int64> ItemGenerations;
+
+	struct FChangeLogEntry
+	{
+		int32 Index;
+		int64 Generation;
+	};
+
+	// Item changes in generation order. An entry is stale once its item has
+	// changed again, stale entries are compacted away as the log grows.
+	TArray<FChangeLogEntry> ChangeLog;
+
+	// The changes of this frame in the order items first changed, only 
+	// recorded while anyone listens.
+	TArray<FInventoryItemChange> PendingChanges;
+
+	// The index of the pending change of each item plus one, or 0 if it has
+	// none. Indexed by FInventoryItemId::Index.
+	TArray<int32> PendingChangeIndices;
+
+	// The changes being broadcast, reused every frame
+	TArray<FInventoryItemChange> FlushingChanges;
+
+	// Per item subscriptions, keyed by FInventoryItemId::Index. Held by 
+	// pointer and never removed, so subscribing or unsubscribing from a 
+	// subscriber cannot move or destroy the delegate being broadcast.
+	TMap<int32, TUniquePtr<FOnInventoryItemChanged>> ItemSubscriptions;
+
+	FInventorySnapshotPublisher SnapshotPublisher;
+
+	// Set once EnableSnapshots was called
+	bool bPublishSnapshots = false;
 
-	TMap<FString, FInventoryItem> Inventory;
+	// The generation of the published snapshot, INDEX_NONE if it is stale
+	// for another reason, e.g. an item type was registered.
+	int64 PublishedGeneration = INDEX_NONE;
 };
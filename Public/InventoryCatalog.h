@@ -0,0 +1,402 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UObject/ObjectMacros.h"
+#include "Engine/DataTable.h"
+#include "Async/MappedFileHandle.h"
+#include "InventoryTypes.h"
+#include "InventoryCatalogBlob.h"
+#include "InventoryCatalog.generated.h"
+
+// The definition of an inventory item type. Also usable as the row struct of
+// a DataTable of item types, see UInventory::AddInventoryItemTypesFromDataTable.
+USTRUCT(BlueprintType)
+struct FInventoryItemDefinition : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	// The name of this inventory item. Rows of a DataTable with an empty name
+	// use their row name.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	FString Name = "";
+
+	// The flavor text of this inventory item
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	FString FlavorText = "";
+
+	// The thumbnail of this inventory item
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	UTexture2D* Thumbnail = nullptr;
+
+	// The full image of this inventory item
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	UTexture2D* FullImage = nullptr;
+
+	// A TMap containing strings specifying a stat and a BoostAndDuration 
+	// struct which specifies the boost to the respective stat as well as the
+	// duration of the boost.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	TMap<FString, FBoostAndDuration> StatsBoostsAndDurations;
+
+	// The maximum allowable quantity of this inventory item. Negative values treated as 0.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	int MaximumQuantity = 1;
+
+	// Is this item equippable?
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	bool IsEquippable = false;
+
+	// Is this this item consumable?
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryItemDefinition")
+	bool IsConsumable = true;
+};
+
+// A single stat modifier of an item type, keyed by interned stat id
+struct FInventoryStatModifier
+{
+	int32 StatId = INDEX_NONE;
+	int32 Boost = 0;
+	int32 Duration = 0;
+	int32 Period = 0;
+
+	bool operator==(const FInventoryStatModifier& Other) const
+	{
+		return StatId == Other.StatId && Boost == Other.Boost && Duration == Other.Duration && Period == Other.Period;
+	}
+};
+
+// An item type in a per stat index. Indexes are sorted by boost, highest 
+// first, then by item id.
+struct FInventoryStatIndexEntry
+{
+	int32 Boost = 0;
+	FInventoryItemId ItemId;
+
+	bool operator==(const FInventoryStatIndexEntry& Other) const
+	{
+		return Boost == Other.Boost && ItemId == Other.ItemId;
+	}
+
+	// The order of the per stat indexes
+	static bool Precedes(const FInventoryStatIndexEntry& A, const FInventoryStatIndexEntry& B)
+	{
+		return A.Boost != B.Boost ? A.Boost > B.Boost : A.ItemId.Index < B.ItemId.Index;
+	}
+};
+
+// The modifiers of an item type sorted by stat id. Nearly every item has a
+// handful of stats, so these live inline without a heap allocation.
+typedef TArray<FInventoryStatModifier, TInlineAllocator<4>> FInventoryModifierSet;
+
+/**
+ * Immutable item type definitions shared by every UInventory that uses this
+ * catalog. Definitions are only ever appended, so an FInventoryItemId stays 
+ * valid for the lifetime of the catalog. Inventories only store their own
+ * per-item state and look everything else up here.
+ *
+ * A catalog can start from a cooked catalog, see LoadCookedCatalog. Its item
+ * types and stats come first and are read in place from the cooked catalog,
+ * item types and stats added at runtime follow them.
+ */
+UCLASS(BlueprintType)
+class INVENTORYSYSTEM_API UInventoryCatalog : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds an item type definition to the catalog. Adding a definition
+	 * identical to an existing one is not an error, this is how many 
+	 * inventories registering the same item types end up sharing them.
+	 * @param Definition - The definition to add.
+	 * @param AllowedStats - If set, bits indexed by stat id of the stats the
+	 * definition may use.
+	 * @param OutItemId - Set to the handle of the item type on ESuccess, or
+	 * to the handle of the conflicting item type on EDuplicateItemType.
+	 * @return ESuccess if the definition was added or an identical 
+	 * definition already exists.
+	 * EInvalidStatUsed if a stat of the definition is not an interned stat,
+	 * or not in AllowedStats.
+	 * EDuplicateItemType if a different definition with the same name 
+	 * already exists.
+	 */
+	InventoryError AddItemType(FInventoryItemDefinition&& Definition, FInventoryItemId& OutItemId, 
+							const TBitArray<>* AllowedStats = nullptr);
+
+	/** Adds many item type definitions at once, e.g. a whole catalog at 
+	 * BeginPlay. Reserves storage for all of them up front and moves each
+	 * definition into the catalog. Logs how long registration took.
+	 * @param Definitions - The definitions to add. Each is moved from.
+	 * @param OutItemIds - Reset and filled with the handle of each 
+	 * definition as AddItemType would set it.
+	 * @param OutResults - Reset and filled with the result of each 
+	 * definition as AddItemType would return it.
+	 * @param AllowedStats - As for AddItemType.
+	 * @return The number of definitions that were added or already existed.
+	 */
+	int32 AddItemTypes(TArrayView<FInventoryItemDefinition> Definitions, TArray<FInventoryItemId>& OutItemIds, 
+					TArray<InventoryError>& OutResults, const TBitArray<>* AllowedStats = nullptr);
+
+	// Reserves storage for NumItemTypes more item types
+	void ReserveItemTypes(const int32 NumItemTypes);
+
+	/** Interns a stat name. Adding the same stat twice returns the same id.
+	 * @return The small dense id of the stat, used to index stat arrays.
+	 */
+	int32 AddStat(const FString& StatName);
+
+	/** Resolves a stat name to its id.
+	 * @return The stat id, or INDEX_NONE if the stat was never added.
+	 */
+	int32 FindStatId(FStringView StatName) const;
+
+	// The name of a stat, StatId must be valid
+	FStringView GetStatName(const int32 StatId) const
+	{
+		return StatId < NumMappedStats ? Blob.GetStatName(StatId) : FStringView(StatNames[StatId - NumMappedStats]);
+	}
+
+	// The number of interned stats. Stat ids are dense in [0, NumStats()).
+	int32 NumStats() const { return NumMappedStats + StatNames.Num(); }
+
+	// The modifiers of an item type sorted by stat id, ItemId must be valid
+	TConstArrayView<FInventoryStatModifier> GetModifiers(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.GetModifiers(ItemId.Index)
+			: TConstArrayView<FInventoryStatModifier>(ModifierSets[ItemModifierSets[ItemId.Index - NumMappedItems]]);
+	}
+
+	// Rebuilds the stat name keyed map of an item type, ItemId must be valid
+	TMap<FString, FBoostAndDuration> MakeStatsBoostsAndDurations(const FInventoryItemId ItemId) const;
+
+	// As above, reusing the allocation of OutStatsBoostsAndDurations
+	void GetStatsBoostsAndDurationsInto(const FInventoryItemId ItemId, TMap<FString, FBoostAndDuration>& OutStatsBoostsAndDurations) const;
+
+	/** Get every item type boosting a stat, highest boost first. Built on
+	 * first use after item types were added, O(result) afterwards.
+	 * @return The index of StatId, empty if StatId is not a stat.
+	 */
+	TConstArrayView<FInventoryStatIndexEntry> GetItemsByStat(const int32 StatId) const;
+
+	/** Get the item types whose name starts with a prefix, in name order.
+	 * The name indexes are built on first use after item types were added.
+	 * @param FoldedPrefix - A prefix folded with FoldName.
+	 * @return A view of the name index, O(log Num()).
+	 */
+	TConstArrayView<FInventoryItemId> GetItemsByNamePrefix(FStringView FoldedPrefix) const;
+
+	/** Get candidates for the item types whose name contains a string.
+	 * @param FoldedQuery - At least three characters folded with FoldName.
+	 * @return The item types whose name contains the rarest three character
+	 * sequence of FoldedQuery, in item id order. Every item type whose name
+	 * contains FoldedQuery is among them, check GetFoldedName to exclude the
+	 * others.
+	 */
+	TConstArrayView<FInventoryItemId> GetItemsByNameTrigram(FStringView FoldedQuery) const;
+
+	/** Get the item types whose name contains a string too short for the
+	 * trigram index.
+	 * @param FoldedQuery - One or two characters folded with FoldName.
+	 * @return Exactly the item types whose name contains FoldedQuery, in 
+	 * item id order.
+	 */
+	TConstArrayView<FInventoryItemId> GetItemsByShortSequence(FStringView FoldedQuery) const;
+
+	// The folded name of an item type, ItemId must be valid
+	FStringView GetFoldedName(const FInventoryItemId ItemId) const;
+
+	// The position of an item type in name order, ItemId must be valid. 
+	// Ranks change whenever the name indexes are rebuilt.
+	int32 GetNameRank(const FInventoryItemId ItemId) const;
+
+	// The name rank of every item type, indexed by FInventoryItemId::Index
+	TConstArrayView<int32> GetNameRanks() const;
+
+	// The category of every item type in sort order, 0 for equippable, 1 for
+	// consumable and 2 for the rest. Indexed by FInventoryItemId::Index and
+	// built with the name indexes.
+	TConstArrayView<uint8> GetCategoryRanks() const;
+
+	// Builds the name indexes if item types were added since they were built,
+	// instead of on first use
+	void BuildNameIndexes() const;
+
+	// Are the name indexes built for the current item types? Name lookups
+	// rebuild them first if not.
+	bool AreNameIndexesBuilt() const { return bNameIndexesValid; }
+
+	// Incremented every time the name indexes are rebuilt, 0 before the first
+	uint32 GetNameIndexVersion() const { return NameIndexVersion; }
+
+	// Folds a name for case insensitive search
+	static void FoldName(FStringView Name, FString& OutFolded);
+
+	// The number of distinct modifier sets shared by all item types
+	int32 NumModifierSets() const { return Blob.NumModifierSets() + ModifierSets.Num(); }
+
+	/** Resolves the name of an item type to its handle.
+	 * @return The handle of the item type, or an invalid handle if no item 
+	 * type with this name exists in the catalog.
+	 */
+	FInventoryItemId FindItemId(FStringView Name) const;
+
+	// Is ItemId a handle to an item type in this catalog?
+	bool IsValidItemId(const FInventoryItemId ItemId) const { return ItemId.Index >= 0 && ItemId.Index < Num(); }
+
+	// Hot per item fields, ItemId must be valid.
+	int32 GetMaximumQuantity(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.GetMaximumQuantity(ItemId.Index) : MaximumQuantities[ItemId.Index - NumMappedItems];
+	}
+
+	bool IsConsumable(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.IsConsumable(ItemId.Index) : ConsumableItems[ItemId.Index - NumMappedItems];
+	}
+
+	bool IsEquippable(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.IsEquippable(ItemId.Index) : EquippableItems[ItemId.Index - NumMappedItems];
+	}
+
+	// Cold per item fields, ItemId must be valid.
+	FStringView GetName(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.GetName(ItemId.Index) : FStringView(Definitions[ItemId.Index - NumMappedItems].Name);
+	}
+
+	FStringView GetFlavorText(const FInventoryItemId ItemId) const
+	{
+		return ItemId.Index < NumMappedItems ? Blob.GetFlavorText(ItemId.Index) : FStringView(Definitions[ItemId.Index - NumMappedItems].FlavorText);
+	}
+
+	// The images of an item type, ItemId must be valid. Images of cooked item
+	// types are loaded on first use.
+	UTexture2D* GetThumbnail(const FInventoryItemId ItemId) const;
+	UTexture2D* GetFullImage(const FInventoryItemId ItemId) const;
+
+	// The object paths of the images of an item type, ItemId must be valid
+	FString GetThumbnailPath(const FInventoryItemId ItemId) const;
+	FString GetFullImagePath(const FInventoryItemId ItemId) const;
+
+	// The number of item types in this catalog. Item ids are dense in [0, Num()).
+	int32 Num() const { return NumMappedItems + Definitions.Num(); }
+
+	/** Starts this catalog from a cooked catalog file. The file is memory 
+	 * mapped and used in place, so this costs the same for any number of
+	 * item types. Falls back to reading the file on platforms that cannot 
+	 * map it.
+	 * @param Filename - A file written by SaveCookedCatalog.
+	 * @param bVerifyContents - Also verify every record of the file, costs
+	 * O(size of the file).
+	 * @return true if the catalog was loaded. Fails if the file is not a 
+	 * valid cooked catalog for this platform, or if item types or stats were
+	 * already added to this catalog.
+	 */
+	bool LoadCookedCatalog(const FString& Filename, const bool bVerifyContents = false);
+
+	/** Writes every item type and stat of this catalog as a cooked catalog.
+	 * Images are stored by object path.
+	 * @return true if the file was written.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "InventoryCatalog")
+	bool SaveCookedCatalog(const FString& Filename) const;
+
+	/** A hash of every item type and stat of this catalog. Equal for catalogs
+	 * holding the same item types and stats in the same order, whether 
+	 * cooked or added at runtime.
+	 */
+	uint64 GetFingerprint() const;
+
+	UInventoryCatalog();
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+private:
+	// Does the existing item type at Index have exactly these fields?
+	bool IsIdenticalItemType(const int32 Index, const FInventoryItemDefinition& Definition, const FInventoryModifierSet& NewModifiers) const;
+
+	// Loads an image of a cooked item type, ImageIndex is Index * 2 plus 0
+	// for the thumbnail or 1 for the full image.
+	UTexture2D* LoadMappedImage(const int32 ImageIndex, FStringView Path) const;
+
+	// Resolves the stats of a definition to sorted modifiers, without
+	// interning them
+	InventoryError ResolveModifiers(const FInventoryItemDefinition& Definition, const TBitArray<>* AllowedStats, FInventoryModifierSet& OutModifiers) const;
+
+	// Returns the index of the modifier set equal to Modifiers, adding it if
+	// no item type uses these modifiers yet.
+	int32 FindOrAddModifierSet(FInventoryModifierSet&& Modifiers);
+
+	// The mapped cooked catalog, if any. Declared in this order so the region
+	// is unmapped before the file is closed.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// The cooked catalog when it could not be mapped
+	TArray<uint8> LoadedBlob;
+
+	FInventoryCatalogBlob Blob;
+
+	// The number of cooked item types and stats. Runtime item types and 
+	// stats are stored at their id minus these.
+	int32 NumMappedItems = 0;
+	int32 NumMappedStats = 0;
+
+	// Images of cooked item types loaded so far, keyed by image index
+	mutable TMap<int32, UTexture2D*> MappedImages;
+
+	// Drops the fingerprint and every index built from the item types, so
+	// they are rebuilt on their next use
+	void InvalidateDerivedData();
+
+	// Cached by GetFingerprint, cleared whenever an item type or stat is added
+	mutable TOptional<uint64> CachedFingerprint;
+
+	// Built by BuildNameIndexes, cleared whenever an item type is added.
+	// Folded names indexed by item id, item ids sorted by folded name and
+	// the item ids containing each sequence of one, two or three characters.
+	// Also the sort keys FInventorySorter reads per item.
+	mutable TArray<FString> FoldedNames;
+	mutable TArray<FInventoryItemId> ItemsByName;
+	mutable TArray<int32> NameRanks;
+	mutable TArray<uint8> CategoryRanks;
+	mutable TMap<uint64, TArray<FInventoryItemId>> ItemsByTrigram;
+	mutable TMap<uint64, TArray<FInventoryItemId>> ItemsByShortSequence;
+	mutable bool bNameIndexesValid = false;
+	mutable uint32 NameIndexVersion = 0;
+
+	// Built by GetItemsByStat, cleared whenever an item type or stat is added
+	mutable TArray<TArray<FInventoryStatIndexEntry>> ItemsByStat;
+	mutable bool bItemsByStatValid = false;
+
+	// Runtime item type definitions, stats are interned into ModifierSets
+	UPROPERTY()
+	TArray<FInventoryItemDefinition> Definitions;
+
+	// Copies of the fields checked on every mutation, kept in parallel dense
+	// arrays so validation and scans never touch the cold definitions.
+	TArray<int32> MaximumQuantities;
+	TBitArray<> ConsumableItems;
+	TBitArray<> EquippableItems;
+
+	// Maps names of runtime item types to item ids
+	TMap<FString, int32> ItemIds;
+
+	// The modifier set of each runtime item type, indices into ModifierSets
+	TArray<int32> ItemModifierSets;
+
+	// Distinct modifier sets shared by all item types, the empty set is 0
+	TArray<FInventoryModifierSet> ModifierSets;
+
+	// Maps modifier set hashes to indices into ModifierSets
+	TMultiMap<uint32, int32> ModifierSetIds;
+
+	// Names of runtime stats
+	TArray<FString> StatNames;
+
+	// Maps names of runtime stats to stat ids
+	TMap<FString, int32> StatIds;
+};
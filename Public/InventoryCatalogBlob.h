@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UInventoryCatalog;
+struct FInventoryStatModifier;
+
+// A range of elements in a section of a cooked catalog
+struct FInventoryCatalogBlobRange
+{
+	uint32 First;
+	uint32 Num;
+};
+
+/**
+ * Header of a cooked catalog. Every section is 8 byte aligned and addressed
+ * by its byte offset from the start of the blob. Strings are stored as
+ * TCHARs without terminator, so a cooked catalog is only valid on platforms
+ * with the TCHAR size it was cooked with.
+ */
+struct FInventoryCatalogBlobHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 CharSize;
+	uint32 NumItems;
+	uint32 NumStats;
+	uint32 NumModifierSets;
+	uint32 NumModifiers;
+
+	// Sizes of the open addressing name tables, powers of two
+	uint32 NumItemSlots;
+	uint32 NumStatSlots;
+	uint32 Padding;
+
+	// Hash of everything following the header, seeded with the counts above
+	uint64 Fingerprint;
+
+	uint64 TotalSize;
+
+	uint64 MaximumQuantitiesOffset;		// int32[NumItems]
+	uint64 ConsumableBitsOffset;		// uint32[(NumItems + 31) / 32]
+	uint64 EquippableBitsOffset;		// uint32[(NumItems + 31) / 32]
+	uint64 ItemModifierSetsOffset;		// uint32[NumItems]
+	uint64 ModifierSetsOffset;			// FInventoryCatalogBlobRange[NumModifierSets] into the modifiers
+	uint64 ModifiersOffset;				// FInventoryStatModifier[NumModifiers]
+	uint64 ItemStringsOffset;			// FInventoryCatalogBlobRange[NumItems * 4] into the strings
+	uint64 StatStringsOffset;			// FInventoryCatalogBlobRange[NumStats] into the strings
+	uint64 ItemSlotsOffset;				// uint32[NumItemSlots], item index + 1 or 0 if empty
+	uint64 StatSlotsOffset;				// uint32[NumStatSlots], stat id + 1 or 0 if empty
+	uint64 StringsOffset;				// TCHAR[StringsLength]
+	uint64 StringsLength;
+};
+
+/**
+ * A read only view of a cooked catalog. A cooked catalog is used in place,
+ * straight from a memory mapped file, so loading it costs the same for any
+ * number of item types and processes mapping the same file share its pages.
+ */
+class INVENTORYSYSTEM_API FInventoryCatalogBlob
+{
+public:
+	static constexpr uint32 Magic = 0x54414349; // "ICAT"
+	static constexpr uint32 Version = 1;
+
+	/** Points this view at a cooked catalog. The memory must stay valid and
+	 * unchanged while the view is used.
+	 * @param bVerifyContents - Also verify every record and the fingerprint.
+	 * This costs O(size of the blob), without it only the header and the
+	 * section bounds are checked.
+	 * @return true if the blob is a valid cooked catalog for this platform.
+	 */
+	bool Initialize(const uint8* InData, const int64 InSize, const bool bVerifyContents);
+
+	// Writes a cooked catalog holding every stat and item type of Catalog
+	static void Write(const UInventoryCatalog& Catalog, TArray<uint8>& OutBlob);
+
+	// The case insensitive hash used by the name tables
+	static uint32 HashName(FStringView Name);
+
+	bool IsValid() const { return Header != nullptr; }
+
+	int32 NumItems() const { return Header ? Header->NumItems : 0; }
+	int32 NumStats() const { return Header ? Header->NumStats : 0; }
+	int32 NumModifierSets() const { return Header ? Header->NumModifierSets : 0; }
+	uint64 GetFingerprint() const { return Header->Fingerprint; }
+
+	int32 GetMaximumQuantity(const int32 Index) const { return MaximumQuantities[Index]; }
+	bool IsConsumable(const int32 Index) const { return (ConsumableBits[Index >> 5] >> (Index & 31)) & 1; }
+	bool IsEquippable(const int32 Index) const { return (EquippableBits[Index >> 5] >> (Index & 31)) & 1; }
+	TConstArrayView<FInventoryStatModifier> GetModifiers(const int32 Index) const;
+
+	FStringView GetName(const int32 Index) const { return GetString(ItemStrings[Index * 4 + 0]); }
+	FStringView GetFlavorText(const int32 Index) const { return GetString(ItemStrings[Index * 4 + 1]); }
+	FStringView GetThumbnailPath(const int32 Index) const { return GetString(ItemStrings[Index * 4 + 2]); }
+	FStringView GetFullImagePath(const int32 Index) const { return GetString(ItemStrings[Index * 4 + 3]); }
+	FStringView GetStatName(const int32 StatId) const { return GetString(StatStrings[StatId]); }
+
+	// Resolve names through the name tables, INDEX_NONE if not found
+	int32 FindItem(FStringView Name) const;
+	int32 FindStat(FStringView Name) const;
+
+private:
+	FStringView GetString(const FInventoryCatalogBlobRange& Range) const
+	{
+		return FStringView(Strings + Range.First, Range.Num);
+	}
+
+	bool VerifyContents() const;
+
+	const FInventoryCatalogBlobHeader* Header = nullptr;
+	const int32* MaximumQuantities = nullptr;
+	const uint32* ConsumableBits = nullptr;
+	const uint32* EquippableBits = nullptr;
+	const uint32* ItemModifierSets = nullptr;
+	const FInventoryCatalogBlobRange* ModifierSets = nullptr;
+	const FInventoryStatModifier* Modifiers = nullptr;
+	const FInventoryCatalogBlobRange* ItemStrings = nullptr;
+	const FInventoryCatalogBlobRange* StatStrings = nullptr;
+	const uint32* ItemSlots = nullptr;
+	const uint32* StatSlots = nullptr;
+	const TCHAR* Strings = nullptr;
+};
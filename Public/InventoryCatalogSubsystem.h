@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "InventoryCatalogSubsystem.generated.h"
+
+class UInventoryCatalog;
+
+/**
+ * Owns the item catalog shared by every UInventory in the game instance.
+ */
+UCLASS(Config = Game)
+class INVENTORYSYSTEM_API UInventoryCatalogSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Get the shared item catalog
+	 * @return The catalog used by every UInventory in this game instance.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	UInventoryCatalog* GetCatalog() const { return Catalog; }
+
+private:
+	UPROPERTY()
+	UInventoryCatalog* Catalog = nullptr;
+
+	// A cooked catalog the shared catalog starts from, relative to the 
+	// project directory. Empty to start from an empty catalog.
+	UPROPERTY(Config)
+	FString CookedCatalogFile;
+};
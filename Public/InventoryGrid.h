@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "Components/ActorComponent.h"
+#include "InventoryTypes.h"
+#include "InventoryGrid.generated.h"
+
+class UInventory;
+
+USTRUCT(BlueprintType)
+struct FInventoryGridPlacement
+{
+	GENERATED_BODY()
+
+	// The placed item type. One placement holds the whole stack of the type.
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryGridPlacement")
+	FInventoryItemId ItemId;
+
+	// The cell of the top left corner of the item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryGridPlacement")
+	FIntPoint Position = FIntPoint::ZeroValue;
+
+	// The number of cells the item spans horizontally and vertically
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryGridPlacement")
+	FIntPoint Size = FIntPoint(1, 1);
+};
+
+/**
+ * Lays out the items of the UInventory of the same actor in a grid, each
+ * owned item type taking up a rectangle of cells. The occupancy of each row
+ * is one 64 bit word, so fit checks and placement searches test a whole row
+ * of cells per operation. Items gained or lost through the inventory itself
+ * are placed or removed at the end of the frame, when it broadcasts its
+ * changes.
+ */
+UCLASS( ClassGroup=(Inventory), meta=(BlueprintSpawnableComponent) )
+class INVENTORYSYSTEM_API UInventoryGrid : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 MaxWidth = 64;
+
+	UInventoryGrid();
+
+	// The number of columns of the grid, at most MaxWidth
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "InventoryGrid", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 Width = 10;
+
+	// The number of rows of the grid
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "InventoryGrid", meta = (ClampMin = "1"))
+	int32 Height = 6;
+
+	// Rearrange the whole grid when an item gained does not fit as it is
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryGrid")
+	bool bAutoArrange = true;
+
+	/** Sets the number of cells an item type spans. Item types without a
+	 * footprint span a single cell. Does not move items already placed.
+	 * @param Item - The name of an inventory item type.
+	 * @param Size - The footprint, clamped to at least one cell and at most
+	 * MaxWidth columns.
+	 * @return ESuccess if the footprint was set. EInvalidItemType if no item
+	 * type with this name exists in the inventory.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	InventoryError SetItemFootprint(const FString& Item, const FIntPoint Size);
+	void SetItemFootprint(const FInventoryItemId ItemId, const FIntPoint Size);
+
+	// The number of cells an item type spans
+	FIntPoint GetItemFootprint(const FInventoryItemId ItemId) const;
+
+	/** Adds items to the inventory, placing their type in the grid first if
+	 * it is not placed yet. The grid is only changed if the items are added.
+	 * @return ENoSpace if the item type is not placed and does not fit, even
+	 * after rearranging when bAutoArrange is set. Otherwise whatever
+	 * UInventory::AddItem returns.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	InventoryError AddItem(const FString& ItemToAdd, const int Quantity = 1);
+	InventoryError AddItem(const FInventoryItemId ItemToAdd, const int Quantity = 1);
+
+	// Could AddItem place the item type without rearranging the grid?
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	bool CanFitItem(const FString& Item) const;
+	bool CanFitItem(const FInventoryItemId ItemId) const;
+
+	// Are all cells of the rectangle inside the grid and free?
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	bool IsAreaFree(const FIntPoint Position, const FIntPoint Size) const;
+
+	/** Finds the first free rectangle of the given size in row major order.
+	 * O(Height * log(Size)) word operations.
+	 * @return true if OutPosition was set.
+	 */
+	bool FindFirstFit(const FIntPoint Size, FIntPoint& OutPosition) const;
+
+	/** Finds the free rectangle of the given size that touches the most
+	 * occupied cells and grid borders, keeping the free space in as few and
+	 * as large holes as possible. Ties go to the first in row major order.
+	 * @return true if OutPosition was set.
+	 */
+	bool FindBestFit(const FIntPoint Size, FIntPoint& OutPosition) const;
+
+	/** Moves a placed item type.
+	 * @return true if the item type is placed and its footprint at Position
+	 * only covers free cells or cells of its own.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	bool MoveItem(const FInventoryItemId ItemId, const FIntPoint Position);
+
+	/** Places every placed item type again, largest first, each where
+	 * FindBestFit puts it.
+	 * @return true if the grid was rearranged. false if some item would not
+	 * fit, the grid is left as it was then.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	bool AutoArrange();
+
+	// The item type covering a cell, an invalid handle if the cell is free
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	FInventoryItemId GetItemAt(const FIntPoint Cell) const;
+
+	// Every placed item type, in no particular order
+	UFUNCTION(BlueprintCallable, Category = "InventoryGrid")
+	TArray<FInventoryGridPlacement> GetPlacements() const { return Placements; }
+
+	// The placement of an item type, null if it is not placed
+	const FInventoryGridPlacement* FindPlacement(const FInventoryItemId ItemId) const;
+
+	// The inventory laid out by this grid
+	UInventory* GetInventory() const { return Inventory; }
+
+protected:
+	virtual void OnRegister() override;
+
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or the component is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UFUNCTION()
+	void HandleInventoryChanged(const TArray<FInventoryItemChange>& Changes);
+
+	// Clears the grid to Width by Height free cells
+	void ResetRows();
+
+	/** Finds every free rectangle of the given size.
+	 * @param OutCandidates - Set to a word per row, bit X of word Y is set
+	 * if the rectangle fits with its top left corner at (X, Y).
+	 * @return false if the size does not fit the grid at all.
+	 */
+	bool FindCandidates(const FIntPoint Size, TArray<uint64, TInlineAllocator<64>>& OutCandidates) const;
+
+	// The number of occupied cells and border cells the rectangle touches
+	int32 CountContacts(const FIntPoint Position, const FIntPoint Size) const;
+
+	void SetCells(const FIntPoint Position, const FIntPoint Size, const bool bOccupied);
+
+	// Places an item type where FindBestFit puts it, rearranging the grid if
+	// it does not fit and bAutoArrange is set
+	bool PlaceItem(const FInventoryItemId ItemId);
+
+	void AddPlacement(const FInventoryItemId ItemId, const FIntPoint Position, const FIntPoint Size);
+	void RemovePlacement(const FInventoryItemId ItemId);
+
+	// Rearranges the placed item types and ExtraItemId if it is valid
+	bool Arrange(const FInventoryItemId ExtraItemId);
+
+	static uint64 RowMask(const int32 NumCells)
+	{
+		return NumCells >= MaxWidth ? ~uint64(0) : (uint64(1) << NumCells) - 1;
+	}
+
+	UPROPERTY()
+	UInventory* Inventory = nullptr;
+
+	// The occupancy of each row, bit X is set if cell X is occupied
+	TArray<uint64> Rows;
+
+	UPROPERTY()
+	TArray<FInventoryGridPlacement> Placements;
+
+	// Index into Placements by item id
+	TMap<int32, int32> PlacementIndices;
+
+	// Footprints by item id of item types not spanning a single cell
+	TMap<int32, FIntPoint> Footprints;
+};
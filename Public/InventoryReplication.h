@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+class UInventory;
+
+/**
+ * Serializes the per item state of a UInventory as deltas against the last
+ * state a receiver acknowledged, in the spirit of fast array replication.
+ * A delta holds the catalog fingerprint, the generation it brings the 
+ * receiver up to and a (item id, quantity, equipped) tuple for each item 
+ * that changed since the acknowledged generation. Item ids are delta 
+ * encoded, quantities are packed into just enough bits for the maximum 
+ * quantity of their item type and the equipped bit is only sent for 
+ * equippable item types. Definitions are never sent, both ends must 
+ * register the same item types against catalogs with the same fingerprint.
+ */
+struct INVENTORYSYSTEM_API FInventoryDeltaSerializer
+{
+	/** Writes the changes to an inventory since a generation.
+	 * @param Inventory - The authoritative inventory.
+	 * @param AckedGeneration - The last generation the receiver acknowledged,
+	 * or 0 for a receiver that has nothing yet.
+	 * @param Writer - Receives the delta.
+	 * @return The generation the delta brings the receiver up to, to be 
+	 * acknowledged once the receiver got it.
+	 */
+	static int64 WriteDelta(const UInventory& Inventory, const int64 AckedGeneration, FBitWriter& Writer);
+
+	/** Applies a delta written by WriteDelta. Deltas that arrive after a 
+	 * newer one was applied are ignored, so deltas may be sent unreliably.
+	 * @param Inventory - The receiving inventory.
+	 * @param Reader - The delta.
+	 * @param InOutGeneration - The generation of the last applied delta, 
+	 * updated when this one is applied. Start at 0.
+	 * @return true if the delta was applied or ignored. false if it is 
+	 * malformed, was written against a different catalog or holds a state
+	 * Inventory cannot have, in which case nothing changes.
+	 */
+	static bool ReadDelta(UInventory& Inventory, FBitReader& Reader, int64& InOutGeneration);
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "InventoryTypes.h"
+
+class UInventoryCatalog;
+
+// The per item state of one player in FInventoryService, indexed by 
+// FInventoryItemId::Index. Grows on demand up to the size of the catalog.
+struct FInventoryServicePlayer
+{
+	TArray<int32> Quantities;
+	TBitArray<> EquippedItems;
+
+	int32 GetItemQuantity(const FInventoryItemId ItemId) const
+	{
+		return Quantities.IsValidIndex(ItemId.Index) ? Quantities[ItemId.Index] : 0;
+	}
+
+	bool IsItemEquipped(const FInventoryItemId ItemId) const
+	{
+		return EquippedItems.IsValidIndex(ItemId.Index) && EquippedItems[ItemId.Index];
+	}
+};
+
+/**
+ * Holds the inventories of many players outside of any actor, so systems
+ * off the game thread (persistence, trading, web services) can mutate them
+ * in parallel. Players are spread over shards by player id, each shard 
+ * has its own lock and sits on its own cache line, so operations on 
+ * players of different shards never contend.
+ *
+ * Operations validate like the UInventory operations of the same name. 
+ * Every item type of the catalog is available to every player and consumed
+ * items do not start boosts.
+ *
+ * @warning The catalog is read without synchronization. It must be frozen,
+ * i.e. no item types or stats may be added to it, while the service is in
+ * use.
+ */
+class INVENTORYSYSTEM_API FInventoryService
+{
+public:
+	/** @param InCatalog - The frozen catalog, must outlive the service.
+	 * @param NumShards - The number of shards, rounded up to a power of two.
+	 * 0 to use four per logical core.
+	 */
+	explicit FInventoryService(const UInventoryCatalog& InCatalog, int32 NumShards = 0);
+
+	FInventoryService(const FInventoryService&) = delete;
+	FInventoryService& operator=(const FInventoryService&) = delete;
+
+	/** Removes a player and all their items.
+	 * @return true if the player had any state.
+	 */
+	bool RemovePlayer(const uint64 PlayerId);
+
+	// As UInventory::AddItem. Players are created on their first operation
+	// that succeeds.
+	InventoryError AddItem(const uint64 PlayerId, const FInventoryItemId ItemId, const int32 Quantity = 1);
+
+	// As UInventory::ConsumeItem
+	InventoryError ConsumeItem(const uint64 PlayerId, const FInventoryItemId ItemId, const int32 Quantity = 1);
+
+	// As UInventory::EquipItem
+	InventoryError EquipItem(const uint64 PlayerId, const FInventoryItemId ItemId);
+
+	// As UInventory::UnequipItem
+	InventoryError UnequipItem(const uint64 PlayerId, const FInventoryItemId ItemId);
+
+	/** Applies a list of operations to one player under a single lock, as 
+	 * UInventory::ApplyOps.
+	 * @param OutResults - Reset and filled with the result of each operation.
+	 */
+	void ApplyOps(const uint64 PlayerId, TConstArrayView<FInventoryOp> Ops, TArray<InventoryError>& OutResults);
+
+	// The quantity of an item of a player, 0 for unknown players
+	int32 GetItemQuantity(const uint64 PlayerId, const FInventoryItemId ItemId) const;
+
+	// Is an item of a player equipped? false for unknown players
+	bool IsItemEquipped(const uint64 PlayerId, const FInventoryItemId ItemId) const;
+
+	/** Reads the state of a player under the lock of their shard. Visitor 
+	 * must not call back into the service.
+	 * @return true if the player exists and Visitor was called.
+	 */
+	bool ReadPlayer(const uint64 PlayerId, TFunctionRef<void(const FInventoryServicePlayer& Player)> Visitor) const;
+
+	// The number of players with state, summed over all shards
+	int32 NumPlayers() const;
+
+	int32 NumShards() const { return ShardMask + 1; }
+
+	// The index of the shard holding a player, below NumShards
+	int32 GetShardIndex(const uint64 PlayerId) const;
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+	{
+		mutable FCriticalSection Lock;
+		TMap<uint64, FInventoryServicePlayer> Players;
+	};
+
+	FShard& GetShard(const uint64 PlayerId) const;
+
+	// Applies one operation to a player under the lock of their shard
+	InventoryError ApplyPlayerOp(const uint64 PlayerId, const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity);
+
+	/** Checks whether an operation would succeed, without changing anything.
+	 * The shard of the player must be locked.
+	 * @param Player - The player, null if they have no state yet.
+	 */
+	InventoryError ValidateOp(const FInventoryServicePlayer* Player, const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity) const;
+
+	// Applies an operation ValidateOp accepted, the shard of Player must be locked
+	void ExecuteOp(FInventoryServicePlayer& Player, const InventoryOpType Type, const FInventoryItemId ItemId, const int32 Quantity) const;
+
+	const UInventoryCatalog& Catalog;
+
+	TUniquePtr<FShard[]> Shards;
+	uint32 ShardMask = 0;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "InventoryTypes.h"
+
+/**
+ * An immutable copy of the per item state of a UInventory at the end of a 
+ * frame. Safe to read from any thread for as long as it is referenced.
+ */
+struct INVENTORYSYSTEM_API FInventorySnapshot
+{
+	// The generation of the inventory when the snapshot was taken
+	int64 Generation = 0;
+
+	// Indexed by FInventoryItemId::Index like the inventory state
+	TArray<int32> Quantities;
+	TBitArray<> RegisteredItems;
+	TBitArray<> EquippedItems;
+
+	// Is ItemId an item type registered with the inventory?
+	bool IsRegistered(const FInventoryItemId ItemId) const
+	{
+		return RegisteredItems.IsValidIndex(ItemId.Index) && RegisteredItems[ItemId.Index];
+	}
+
+	// The quantity of an item, 0 if ItemId is not an item type in the inventory
+	int32 GetItemQuantity(const FInventoryItemId ItemId) const
+	{
+		return IsRegistered(ItemId) ? Quantities[ItemId.Index] : 0;
+	}
+
+	// Is an item equipped? false if ItemId is not an item type in the inventory
+	bool IsItemEquipped(const FInventoryItemId ItemId) const
+	{
+		return IsRegistered(ItemId) && EquippedItems[ItemId.Index];
+	}
+};
+
+typedef TSharedPtr<const FInventorySnapshot, ESPMode::ThreadSafe> FInventorySnapshotPtr;
+
+/**
+ * Hands out the latest published snapshot to any number of reader threads
+ * without locks. There are two snapshot slots and a reader count per slot.
+ * A reader announces itself on the current slot, checks the slot is still
+ * current and copies the reference out of it. The single writer fills the
+ * other slot, makes it current and then only waits for the readers that 
+ * were copying out of the old slot, which takes a handful of instructions,
+ * before releasing the old snapshot.
+ */
+class INVENTORYSYSTEM_API FInventorySnapshotPublisher
+{
+public:
+	// Makes Snapshot the one returned by Acquire. Only call from one thread.
+	void Publish(FInventorySnapshotPtr Snapshot);
+
+	// The latest published snapshot, or null if none was published yet.
+	// Safe to call from any thread.
+	FInventorySnapshotPtr Acquire() const;
+
+private:
+	FInventorySnapshotPtr Slots[2];
+
+	// The slot readers copy from
+	std::atomic<int32> CurrentSlot{ 0 };
+
+	// The number of readers announced on each slot
+	mutable std::atomic<int32> NumReaders[2] = { {0}, {0} };
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryTypes.h"
+
+class UInventoryCatalog;
+
+// An element sorted by FInventoryRadixSort
+struct FInventorySortEntry
+{
+	uint64 Key;
+	int32 Value;
+};
+
+/**
+ * Stable LSD radix sort of integer keys, one byte per pass. The histograms 
+ * of all passes are built in a single read of the keys, and passes where 
+ * every key has the same byte are skipped, so narrow or mostly equal keys
+ * cost few passes.
+ */
+struct INVENTORYSYSTEM_API FInventoryRadixSort
+{
+	/** Sorts entries by ascending key, keeping the order of equal keys.
+	 * @param Entries - The entries to sort.
+	 * @param Scratch - Storage reused between calls.
+	 * @param NumKeyBits - Only the lowest NumKeyBits bits of the keys are
+	 * looked at.
+	 */
+	static void Sort(TArray<FInventorySortEntry>& Entries, TArray<FInventorySortEntry>& Scratch, const int32 NumKeyBits = 64);
+};
+
+/**
+ * Sorts item ids by an FInventorySortOrder. Each key is mapped to an 
+ * unsigned integer, name and category ranks read straight from the arrays
+ * the catalog precomputes per item type, boosts and quantities gathered 
+ * once per item, and the integers are packed most significant key first 
+ * into 64 bit words. The words are radix sorted from the least significant to 
+ * the most significant, so no item is ever compared with another.
+ */
+struct INVENTORYSYSTEM_API FInventorySorter
+{
+	/** @param Catalog - The catalog of the items.
+	 * @param Quantities - The quantities indexed by FInventoryItemId::Index.
+	 * @param Order - The sort order.
+	 * @param InOutItemIds - Valid item ids of Catalog, sorted in place.
+	 */
+	static void Sort(const UInventoryCatalog& Catalog, TConstArrayView<int32> Quantities, const FInventorySortOrder& Order, 
+					TArray<FInventoryItemId>& InOutItemIds);
+};
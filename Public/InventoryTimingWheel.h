@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UInventory;
+
+// A boost started by consuming an item, scheduled in FInventoryTimingWheel
+struct FInventoryTimedBoost
+{
+	// The inventory the boost applies to. Boosts of destroyed inventories
+	// are dropped when they fire.
+	TWeakObjectPtr<UInventory> Inventory;
+
+	// The consumed item type
+	int32 ItemIndex = INDEX_NONE;
+
+	// The catalog stat id of the boosted stat
+	int32 StatId = INDEX_NONE;
+
+	// The boost, already multiplied by the number of items consumed together
+	int32 Boost = 0;
+
+	// Ticks between pulses of a periodic boost, 0 if the boost is not periodic
+	uint64 PeriodTicks = 0;
+
+	// The tick of the next pulse of a periodic boost
+	uint64 NextPulseTick = 0;
+
+	// The tick the boost expires at
+	uint64 EndTick = 0;
+};
+
+/**
+ * Hierarchical timing wheel holding every timed boost of a world. Each level
+ * has 64 slots, a slot of level N spans 64^N ticks. Timers move one level
+ * down whenever the level below wraps, so advancing costs O(1) per tick plus
+ * O(1) per timer that fires or moves, independent of how many timers are
+ * scheduled.
+ */
+class INVENTORYSYSTEM_API FInventoryTimingWheel
+{
+public:
+	FInventoryTimingWheel();
+
+	/** Schedules a timer.
+	 * @param Boost - The payload of the timer.
+	 * @param DueTick - The tick to fire at. Ticks at or before the current
+	 * tick fire on the next tick.
+	 * @return The handle of the timer, valid until it is released.
+	 */
+	int32 Schedule(const FInventoryTimedBoost& Boost, const uint64 DueTick);
+
+	/** Schedules a fired timer again, reusing its handle.
+	 * @param Handle - A handle returned by Advance that was not released.
+	 */
+	void Reschedule(const int32 Handle, const uint64 DueTick);
+
+	// Frees the handle of a fired timer that is not rescheduled
+	void Release(const int32 Handle);
+
+	/** Advances the wheel, firing every timer due up to and including ToTick.
+	 * @param OutFired - Appended with the handles of the fired timers. Each
+	 * must be either rescheduled or released.
+	 */
+	void Advance(const uint64 ToTick, TArray<int32>& OutFired);
+
+	// The payload of a timer
+	FInventoryTimedBoost& Get(const int32 Handle) { return Timers[Handle].Boost; }
+
+	// The last tick the wheel advanced to
+	uint64 GetCurrentTick() const { return CurrentTick; }
+
+	// The number of scheduled timers
+	int32 Num() const { return NumScheduled; }
+
+private:
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 NumSlots = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;
+	static constexpr uint64 MaxDelta = (uint64(1) << (SlotBits * NumLevels)) - 1;
+
+	struct FTimer
+	{
+		FInventoryTimedBoost Boost;
+		uint64 DueTick = 0;
+		int32 Next = INDEX_NONE;
+	};
+
+	// Links a timer into the slot its due tick falls into
+	void Insert(const int32 Handle);
+
+	// Moves every timer of the current slot of Level into lower levels
+	void Cascade(const int32 Level);
+
+	TArray<FTimer> Timers;
+
+	// Head of the free list threaded through Timers
+	int32 FreeHead = INDEX_NONE;
+
+	// Heads of the timer lists of every slot of every level
+	int32 Slots[NumLevels][NumSlots];
+
+	uint64 CurrentTick = 0;
+
+	int32 NumScheduled = 0;
+};
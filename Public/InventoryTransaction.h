@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryTypes.h"
+
+class UInventory;
+
+/**
+ * Stages quantity and equip changes to a UInventory and applies them as a
+ * unit. Nothing touches the inventory until Commit, which validates each 
+ * touched item once against its final staged state and then either applies
+ * everything or nothing. Changes are journaled per item, so rolling back 
+ * costs O(touched items) and no snapshot of the inventory is ever taken.
+ * A transaction that is destroyed without being committed rolls back.
+ */
+class INVENTORYSYSTEM_API FInventoryTransaction
+{
+public:
+	explicit FInventoryTransaction(UInventory& InInventory);
+
+	FInventoryTransaction(FInventoryTransaction&&) = default;
+	FInventoryTransaction& operator=(FInventoryTransaction&&) = default;
+
+	/** Stage adding Quantity items. The maximum quantity is checked on Commit.
+	 * @return ESuccess if staged. EInvalidItemType if ItemId is not an item
+	 * type in the inventory.
+	 */
+	InventoryError AddItem(const FInventoryItemId ItemId, const int32 Quantity = 1);
+
+	/** Stage consuming Quantity items. Unlike UInventory::ConsumeItem the 
+	 * whole quantity must be available on Commit.
+	 * @return ESuccess if staged. EInvalidItemType if ItemId is not an item
+	 * type in the inventory.
+	 */
+	InventoryError ConsumeItem(const FInventoryItemId ItemId, const int32 Quantity = 1);
+
+	/** Stage equipping an item.
+	 * @return ESuccess if staged. EInvalidItemType if ItemId is not an item
+	 * type in the inventory. EAlreadyEquipped if it is equipped once the 
+	 * changes staged so far are applied.
+	 */
+	InventoryError EquipItem(const FInventoryItemId ItemId);
+
+	/** Stage unequipping an item.
+	 * @return ESuccess if staged. EInvalidItemType if ItemId is not an item
+	 * type in the inventory. ENotEquipped if it is not equipped once the 
+	 * changes staged so far are applied.
+	 */
+	InventoryError UnequipItem(const FInventoryItemId ItemId);
+
+	/** Validate and apply all staged changes. The transaction is empty 
+	 * afterwards whether or not it succeeded.
+	 * @param OutFailedItem - If set, receives the item that failed validation.
+	 * @return ESuccess if every change was applied.
+	 * EMaxQuantityExceeded if an item would exceed its maximum quantity.
+	 * ENoItemsToConsume if more of an item is consumed than is available.
+	 * ENotConsumable if a consumed item is not consumable.
+	 * ENotEquippable if an equipped or unequipped item is not equippable.
+	 * Nothing is applied if anything fails.
+	 */
+	InventoryError Commit(FInventoryItemId* OutFailedItem = nullptr);
+
+	// Discard all staged changes
+	void Rollback() { Journal.Reset(); }
+
+	// The number of items touched by the staged changes
+	int32 NumTouchedItems() const { return Journal.Num(); }
+
+private:
+	struct FJournalEntry
+	{
+		int32 Index = INDEX_NONE;
+
+		// Items added and consumed by the staged changes
+		int32 Added = 0;
+		int32 Consumed = 0;
+
+		// The staged equip state, relative to the state when first touched
+		bool bOriginalEquipped = false;
+		bool bEquipped = false;
+	};
+
+	// Returns the entry of an item, journaling it on first touch. Returns
+	// nullptr if the item is not an item type in the inventory.
+	FJournalEntry* Touch(const FInventoryItemId ItemId);
+
+	// Nearly every transaction only touches a handful of items
+	TArray<FJournalEntry, TInlineAllocator<8>> Journal;
+
+	TWeakObjectPtr<UInventory> Inventory;
+};
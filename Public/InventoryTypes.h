@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Texture2D.h"
+#include "UObject/ObjectMacros.h"
+#include "InventoryTypes.generated.h"
+
+UENUM(BlueprintType)
+enum class InventoryError : uint8
+{
+	ESuccess					UMETA(DisplayName = "Success"),
+	EInvalidStatUsed			UMETA(DisplayName = "InvalidStatUsed"), 
+	EDuplicateItemType			UMETA(DisplayName = "DuplicateItemType"),
+	EInvalidItemType			UMETA(DisplayName = "InvalidItemType"),
+	EMaxQuantityExceeded		UMETA(DisplayName = "MaxQuantityExceeded"),
+	ENoItemsToConsume			UMETA(DisplayName = "NoItemsToConsume"),
+	ENotEquippable				UMETA(DisplayName = "NotEquippable"),
+	EAlreadyEquipped			UMETA(DisplayName = "AlreadyEquipped"),
+	ENotEquipped				UMETA(DisplayName = "NotEquipped"),
+	ENotConsumable				UMETA(DisplayName = "NotConsumable"),
+	EDuplicateStat				UMETA(DisplayName = "DuplicateStat"),
+	ENoSpace					UMETA(DisplayName = "NoSpace")
+};
+
+UENUM(BlueprintType)
+enum class InventoryOpType : uint8
+{
+	EAdd						UMETA(DisplayName = "Add"),
+	EConsume					UMETA(DisplayName = "Consume"),
+	EEquip						UMETA(DisplayName = "Equip"),
+	EUnequip					UMETA(DisplayName = "Unequip")
+};
+
+UENUM(BlueprintType)
+enum class InventorySortKey : uint8
+{
+	EName						UMETA(DisplayName = "Name"),
+	EQuantity					UMETA(DisplayName = "Quantity"),
+	EStatBoost					UMETA(DisplayName = "StatBoost")
+};
+
+UENUM(BlueprintType)
+enum class InventoryItemFilter : uint8
+{
+	EAll						UMETA(DisplayName = "All"),
+	EConsumable					UMETA(DisplayName = "Consumable"),
+	EEquippable					UMETA(DisplayName = "Equippable")
+};
+
+USTRUCT(BlueprintType)
+struct FBoostAndDuration
+{
+	GENERATED_BODY()
+
+	// The boost to give to the desired stat
+	UPROPERTY(BlueprintReadWrite, Category = "BoostAndDuration")
+	int Boost = 0;
+
+	// The duration of the effect. 0 indicates no duration (i.e infinite). Negative values treated as 0.
+	UPROPERTY(BlueprintReadWrite, Category = "BoostAndDuration")
+	int Duration = 0;
+
+	// The interval of a periodic effect. When consumed, a periodic boost is
+	// delivered as a pulse every Period seconds until Duration instead of 
+	// being held for Duration. 0 indicates no period. Negative values treated as 0.
+	UPROPERTY(BlueprintReadWrite, Category = "BoostAndDuration")
+	int Period = 0;
+
+	bool operator==(const FBoostAndDuration& Other) const
+	{
+		return Boost == Other.Boost && Duration == Other.Duration && Period == Other.Period;
+	}
+	bool operator!=(const FBoostAndDuration& Other) const { return !(*this == Other); }
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryItemId
+{
+	GENERATED_BODY()
+
+	FInventoryItemId() = default;
+
+	explicit FInventoryItemId(const int32 InIndex)
+		: Index(InIndex)
+	{
+	}
+
+	// Does this handle refer to an inventory item type?
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FInventoryItemId& Other) const { return Index == Other.Index; }
+	bool operator!=(const FInventoryItemId& Other) const { return Index != Other.Index; }
+
+	friend uint32 GetTypeHash(const FInventoryItemId& ItemId) { return ::GetTypeHash(ItemId.Index); }
+
+	// The dense index of this item type. INDEX_NONE if this handle is unresolved.
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemId")
+	int32 Index = INDEX_NONE;
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryItemStack
+{
+	GENERATED_BODY()
+
+	// The item type. If not valid the item type is resolved from Name.
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryItemStack")
+	FInventoryItemId ItemId;
+
+	// The name of the item type, only used if ItemId is not valid
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryItemStack")
+	FString Name = "";
+
+	// The number of items
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryItemStack")
+	int Quantity = 1;
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryOp
+{
+	GENERATED_BODY()
+
+	// What to do with the item
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryOp")
+	InventoryOpType Type = InventoryOpType::EAdd;
+
+	// The item type. If not valid the item type is resolved from Name.
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryOp")
+	FInventoryItemId ItemId;
+
+	// The name of the item type, only used if ItemId is not valid
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryOp")
+	FString Name = "";
+
+	// The number of items to add or consume. Ignored by equip and unequip.
+	UPROPERTY(BlueprintReadWrite, Category = "InventoryOp")
+	int Quantity = 1;
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryItem
+{
+	GENERATED_BODY()
+
+	// The name of this inventory item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	FString Name = "";
+
+	// The flavor text of this inventory item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	FString FlavorText = "";
+
+	// The thumbnail of this inventory item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	UTexture2D* Thumbnail = nullptr;
+
+	// The full image of this inventory item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	UTexture2D* FullImage = nullptr;
+
+	// A TMap containing strings specifying a stat and a BoostAndDuration 
+	// struct which specifies the boost to the respective stat as well as the
+	// duration of the boost.
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	TMap<FString, FBoostAndDuration> StatsBoostsAndDurations;
+
+	// The current quantity of this inventory item. Negative values treated as 0.
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	int Quantity = 0;
+
+	// The maximum allowable quantity of this inventory item. Negative values treated as 0.
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	int MaximumQuantity = 0;
+
+	// Is this item equippable?
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	bool IsEquippable = false;
+
+	// Is this item equipped?
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	bool IsEquipped = false;
+
+	// Is this this item consumable?
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItem")
+	bool IsConsumable = false;
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryBoostEvent
+{
+	GENERATED_BODY()
+
+	// The consumed item type the boost came from
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryBoostEvent")
+	FInventoryItemId ItemId;
+
+	// The catalog stat id of the boosted stat
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryBoostEvent")
+	int32 StatId = INDEX_NONE;
+
+	// The boost, already multiplied by the number of items consumed together
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryBoostEvent")
+	int32 Boost = 0;
+
+	// Is the boost periodic? 
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryBoostEvent")
+	bool bPeriodic = false;
+
+	// true if the boost expired, false if this is a pulse of a periodic boost
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryBoostEvent")
+	bool bExpired = false;
+};
+
+USTRUCT(BlueprintType)
+struct FInventoryItemChange
+{
+	GENERATED_BODY()
+
+	// The changed item
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemChange")
+	FInventoryItemId ItemId;
+
+	// The quantity at the start of the frame
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemChange")
+	int32 OldQuantity = 0;
+
+	// The quantity at the end of the frame
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemChange")
+	int32 NewQuantity = 0;
+
+	// Was the item equipped at the start of the frame?
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemChange")
+	bool bOldEquipped = false;
+
+	// Is the item equipped at the end of the frame?
+	UPROPERTY(BlueprintReadOnly, Category = "InventoryItemChange")
+	bool bNewEquipped = false;
+};
+
+// A multi key sort order of inventory items, see UInventory::SortItems.
+// Enabled keys apply from the first to the last, each breaking the ties of
+// the ones before it, and item id breaks the remaining ties.
+USTRUCT(BlueprintType)
+struct FInventorySortOrder
+{
+	GENERATED_BODY()
+
+	// Equippable items first, then consumables, then everything else
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	bool bByCategory = true;
+
+	// The name of a stat to sort by its boost, empty to not sort by a stat.
+	// Items not boosting the stat count as a boost of 0.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	FString Stat = "";
+
+	// Highest boost first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	bool bStatDescending = true;
+
+	// Alphabetically by name, ignoring case
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	bool bByName = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	bool bByQuantity = false;
+
+	// Highest quantity first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventorySortOrder")
+	bool bQuantityDescending = true;
+};
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Containers/Queue.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/Function.h"
+#include "InventoryTypes.h"
+#include "InventoryTimingWheel.h"
+#include "InventoryWorldSubsystem.generated.h"
+
+class UInventory;
+struct FInventoryStatModifier;
+
+// Receives the result of each operation of a queued batch, on the game thread
+typedef TUniqueFunction<void(TConstArrayView<InventoryError> Results)> FInventoryOpsCallback;
+
+/**
+ * Owns all time dependent processing of the inventories of a world in one 
+ * batched update, so UInventory components never tick. Timed boosts of all
+ * inventories live in one timing wheel, so a frame only pays for the boosts
+ * that actually fire in it. Also applies the operations queued from other
+ * threads, broadcasts the change notifications and publishes the snapshots
+ * of all inventories that changed, once per frame.
+ */
+UCLASS()
+class INVENTORYSYSTEM_API UInventoryWorldSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// The length of one timing wheel tick in seconds
+	static constexpr float TickSeconds = 0.1f;
+
+	// Adds an inventory to the batched update. Called by UInventory on BeginPlay.
+	void RegisterInventory(UInventory* Inventory);
+
+	// Removes an inventory from the batched update. Called by UInventory on EndPlay.
+	void UnregisterInventory(UInventory* Inventory);
+
+	// Queues an inventory for the end of frame flush and publish. Called by
+	// UInventory when it changes while anyone listens or reads snapshots.
+	void MarkInventoryDirty(UInventory* Inventory);
+
+	// The inventories of this world that are playing, in no particular order.
+	// Entries are null for inventories that stopped playing during the update.
+	TConstArrayView<UInventory*> GetInventories() const { return Inventories; }
+
+	/** Starts a timed boost. The boost is not started if it never expires
+	 * and is not periodic.
+	 * @param Inventory - The inventory the boost applies to.
+	 * @param ItemId - The consumed item type.
+	 * @param Modifier - The modifier of the consumed item type.
+	 * @param Count - The number of items consumed together.
+	 * @return true if the boost was scheduled.
+	 */
+	bool StartTimedBoost(UInventory* Inventory, const FInventoryItemId ItemId, const FInventoryStatModifier& Modifier, const int32 Count);
+
+	// The number of scheduled timed boosts
+	int32 NumTimedBoosts() const { return TimingWheel.Num(); }
+
+	/** Queues a batch of operations to apply to an inventory at the start of
+	 * the next update, as UInventory::ApplyOps would. Safe to call from any
+	 * thread, enqueueing never takes a lock.
+	 * @param Inventory - The inventory to apply the operations to. If it is
+	 * destroyed before the update every operation fails with 
+	 * EInvalidItemType.
+	 * @param Ops - The operations.
+	 * @param OnApplied - Optional, called on the game thread with the result
+	 * of each operation once they were applied.
+	 */
+	void EnqueueOps(TWeakObjectPtr<UInventory> Inventory, TArray<FInventoryOp>&& Ops, FInventoryOpsCallback&& OnApplied = nullptr);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	// Applies the operations queued before the update started
+	void ApplyQueuedOps();
+
+	// Advances all timed boosts and delivers the fired ones to their inventories
+	void AdvanceTimedBoosts(const float DeltaTime);
+
+	// Broadcasts the coalesced changes of the dirty inventories
+	void FlushChanges();
+
+	// Publishes the snapshots of the inventories that changed this frame, 
+	// after everything else of the update so they see the final state.
+	void PublishSnapshots();
+
+	// Removes the entries of inventories that unregistered during the update
+	void CompactInventories();
+
+	// Empties DirtyInventories after the update, keeping the inventories
+	// whose listeners changed them while being notified
+	void ResetDirtyInventories();
+
+	// Every playing inventory of this world. UInventory::WorldIndex is the
+	// index of an inventory in this array.
+	TArray<UInventory*> Inventories;
+
+	// The inventories with changes to flush or a snapshot to publish at the
+	// end of this frame, so the update never visits the unchanged ones. 
+	// UInventory::DirtyIndex is the index of an inventory in this array.
+	TArray<UInventory*> DirtyInventories;
+
+	// Set during the update. Inventories unregistering meanwhile (e.g. 
+	// destroyed by a callback) are nulled instead of swapped out, in both
+	// arrays, so the indices of the batch stay valid.
+	bool bUpdating = false;
+	bool bHasUnregisteredDuringUpdate = false;
+
+	FInventoryTimingWheel TimingWheel;
+
+	struct FQueuedOps
+	{
+		TWeakObjectPtr<UInventory> Inventory;
+		TArray<FInventoryOp> Ops;
+		FInventoryOpsCallback OnApplied;
+	};
+
+	// Operations queued from any thread, drained by the update
+	TQueue<FQueuedOps, EQueueMode::Mpsc> QueuedOps;
+
+	// The number of batches in QueuedOps, so batches queued by callbacks 
+	// during the update wait for the next one.
+	FThreadSafeCounter NumQueuedOps;
+
+	// Time accumulated since the wheel started, in seconds
+	double ElapsedSeconds = 0.0;
+
+	// Scratch space reused by every update
+	TArray<int32> FiredTimers;
+	TArray<TPair<int32, FInventoryBoostEvent>> FiredEvents;
+	TArray<FInventoryBoostEvent> InventoryEvents;
+	TArray<InventoryError> QueuedOpResults;
+};